@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace quantum_allocation {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+inline double nanosecondsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Keeps the compiler from discarding a value whose only use is the timing
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct Percentiles {
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+};
+
+// Sorts the samples in place
+inline Percentiles percentiles(std::vector<double>& samples) {
+    Percentiles result;
+    if (samples.empty()) return result;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    result.p50 = at(0.50);
+    result.p99 = at(0.99);
+    result.p999 = at(0.999);
+    result.max = samples.back();
+    return result;
+}
+
+// "--name" flags and "--name=value" options
+class Args {
+public:
+    Args(int argc, char** argv) : args_(argv + 1, argv + argc) {}
+
+    bool has(const char* name) const {
+        std::string flag = std::string("--") + name;
+        return std::find(args_.begin(), args_.end(), flag) != args_.end();
+    }
+
+    double get(const char* name, double fallback) const {
+        const char* value = find(name);
+        return value ? std::atof(value) : fallback;
+    }
+
+    std::string get(const char* name, const std::string& fallback) const {
+        const char* value = find(name);
+        return value ? std::string(value) : fallback;
+    }
+
+private:
+    const char* find(const char* name) const {
+        std::string prefix = std::string("--") + name + "=";
+        for (const std::string& arg : args_) {
+            if (arg.compare(0, prefix.size(), prefix) == 0) return arg.c_str() + prefix.size();
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> args_;
+};
+
+} // namespace bench
+} // namespace quantum_allocation
@@ -0,0 +1,68 @@
+// Scenarios per second through optimizeBatch() against one optimize()
+// call per scenario.
+//
+//   bench_batch [--assets=16] [--scenarios=512] [--iterations=1000] [--threads=0]
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "QuantumOptimizer.hpp"
+#include "ThreadPool.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    const size_t n = static_cast<size_t>(args.get("assets", 16.0));
+    const size_t count = static_cast<size_t>(args.get("scenarios", 512.0));
+    ThreadPool pool(static_cast<size_t>(args.get("threads", 0.0)));
+
+    OptimizationParameters params{0.5, 1.0, static_cast<int>(args.get("iterations", 1000.0)), 0.01};
+
+    // Stressed copies of one base market: scaled returns, inflated covariance
+    std::mt19937_64 gen(42);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<QuantumOptimizer::Scenario> scenarios(count);
+    for (auto& scenario : scenarios) {
+        scenario.returns.resize(n);
+        scenario.covariance.assign(n, std::vector<double>(n));
+        double stress = 1.0 + 0.5 * std::abs(noise(gen));
+        for (size_t i = 0; i < n; ++i) {
+            scenario.returns[i] = 0.001 * noise(gen) / stress;
+            for (size_t j = 0; j <= i; ++j) {
+                double c = i == j ? 4e-4 : 1e-4 * noise(gen);
+                scenario.covariance[i][j] = scenario.covariance[j][i] = c * stress;
+            }
+        }
+    }
+
+    QuantumOptimizer batch(n, params, &pool);
+    auto allocations = batch.optimizeBatch(scenarios);  // Warm the circuits and buffers
+    allocations = batch.optimizeBatch(scenarios);
+    const auto& stats = batch.lastBatchStats();
+
+    // One optimize() per scenario from a fresh superposition, as callers
+    // had to before the batch API
+    params.warm_start = false;
+    QuantumOptimizer single(n, params, &pool);
+    auto start = Clock::now();
+    double worst = 0.0;
+    for (size_t s = 0; s < count; ++s) {
+        auto allocation = single.optimize(scenarios[s].returns, scenarios[s].covariance);
+        for (size_t i = 0; i < n; ++i) {
+            worst = std::max(worst, std::abs(allocation[i] - allocations[s][i]));
+        }
+    }
+    double single_ms = bench::millisecondsSince(start);
+
+    std::printf("%zu assets, %zu scenarios, %d iterations, %zu threads\n", n, count,
+                params.num_iterations, pool.size());
+    std::printf("optimizeBatch: %.1f ms, %.0f scenarios/s\n", stats.elapsed_ms,
+                stats.scenarios_per_second);
+    std::printf("optimize loop: %.1f ms, %.0f scenarios/s (%.1fx slower)\n", single_ms,
+                count * 1000.0 / single_ms, single_ms / stats.elapsed_ms);
+    std::printf("max allocation difference: %.2e\n", worst);
+    return 0;
+}
@@ -0,0 +1,241 @@
+// ClassicalOptimizer against closed-form and KKT references, and its
+// latency on larger books.
+//
+//   bench_classical [--assets=500] [--calls=20] [--iterations=1000]
+//   bench_classical --check     (reference problems, exit status only)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "ClassicalOptimizer.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+// Large enough that risk keeps a good part of a random book in the optimum
+constexpr double kRiskAversion = 200.0;
+
+using Matrix = std::vector<std::vector<double>>;
+
+struct Problem {
+    std::vector<double> returns;
+    Matrix covariance;
+};
+
+// Factor-model covariance (B B' / k plus specific variance), so it is
+// positive definite and has a realistic spread of eigenvalues
+Problem randomProblem(size_t n, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const size_t factors = 8;
+    Matrix loadings(n, std::vector<double>(factors));
+    for (auto& row : loadings) {
+        for (double& b : row) b = 0.01 * noise(gen);
+    }
+    Problem p{std::vector<double>(n), Matrix(n, std::vector<double>(n))};
+    for (size_t i = 0; i < n; ++i) {
+        p.returns[i] = 0.0005 + 0.001 * noise(gen);
+        for (size_t j = 0; j <= i; ++j) {
+            double c = 0.0;
+            for (size_t f = 0; f < factors; ++f) c += loadings[i][f] * loadings[j][f];
+            c /= factors;
+            if (i == j) c += 1e-4 * (1.0 + std::abs(noise(gen)));
+            p.covariance[i][j] = p.covariance[j][i] = c;
+        }
+    }
+    return p;
+}
+
+// Solve A x = b by Gaussian elimination with partial pivoting
+std::vector<double> solve(Matrix a, std::vector<double> b) {
+    const size_t n = b.size();
+    for (size_t k = 0; k < n; ++k) {
+        size_t pivot = k;
+        for (size_t i = k + 1; i < n; ++i) {
+            if (std::abs(a[i][k]) > std::abs(a[pivot][k])) pivot = i;
+        }
+        std::swap(a[k], a[pivot]);
+        std::swap(b[k], b[pivot]);
+        for (size_t i = k + 1; i < n; ++i) {
+            double factor = a[i][k] / a[k][k];
+            for (size_t j = k; j < n; ++j) a[i][j] -= factor * a[k][j];
+            b[i] -= factor * b[k];
+        }
+    }
+    std::vector<double> x(n);
+    for (size_t k = n; k-- > 0;) {
+        double sum = b[k];
+        for (size_t j = k + 1; j < n; ++j) sum -= a[k][j] * x[j];
+        x[k] = sum / a[k][k];
+    }
+    return x;
+}
+
+// Budget-constrained optimum with no bounds:
+//   w = C^-1 (r - nu 1) / (2 ra), nu chosen so that sum w = 1
+std::vector<double> closedForm(const Problem& p, double risk_aversion) {
+    auto x = solve(p.covariance, p.returns);
+    auto y = solve(p.covariance, std::vector<double>(p.returns.size(), 1.0));
+    double sx = 0.0, sy = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sx += x[i];
+        sy += y[i];
+    }
+    double nu = (sx - 2.0 * risk_aversion) / sy;
+    std::vector<double> w(x.size());
+    for (size_t i = 0; i < w.size(); ++i) w[i] = (x[i] - nu * y[i]) / (2.0 * risk_aversion);
+    return w;
+}
+
+// KKT residual on the simplex, relative to the gradient's scale: the
+// gradient of U must be equal (to nu) on the support and no larger off it
+double kktResidual(const Problem& p, double risk_aversion, const std::vector<double>& w) {
+    const size_t n = w.size();
+    std::vector<double> g(n);
+    double scale = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double cw = 0.0;
+        for (size_t j = 0; j < n; ++j) cw += p.covariance[i][j] * w[j];
+        g[i] = p.returns[i] - 2.0 * risk_aversion * cw;
+        scale = std::max(scale, std::abs(g[i]));
+    }
+    double nu = -1e300, sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (w[i] > 1e-9) nu = std::max(nu, g[i]);
+        sum += w[i];
+    }
+    double residual = std::abs(sum - 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        double gap = w[i] > 1e-9 ? std::abs(g[i] - nu) : std::max(0.0, g[i] - nu);
+        residual = std::max(residual, gap / scale);
+    }
+    return residual;
+}
+
+double maxDifference(const std::vector<double>& a, const std::vector<double>& b) {
+    double worst = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) worst = std::max(worst, std::abs(a[i] - b[i]));
+    return worst;
+}
+
+bool check() {
+    bool ok = true;
+    auto report = [&](const char* label, double error, double limit) {
+        bool pass = error < limit;
+        std::printf("%-44s %10.2e %s\n", label, error, pass ? "ok" : "FAIL");
+        ok = ok && pass;
+    };
+    OptimizationParameters params{0.5, 1.0, 5000, 0.01};
+    params.convergence_tolerance = 1e-12;
+
+    // Identical assets: the equal split is optimal for any risk aversion
+    {
+        Problem p{std::vector<double>(6, 0.001), Matrix(6, std::vector<double>(6, 1e-4))};
+        for (size_t i = 0; i < 6; ++i) p.covariance[i][i] = 4e-4;
+        ClassicalOptimizer optimizer(6, params);
+        auto w = optimizer.optimize(p.returns, p.covariance);
+        report("symmetric 6 assets vs 1/6", maxDifference(w, std::vector<double>(6, 1.0 / 6)),
+               1e-9);
+    }
+
+    // Small return spread on a well-diversified book: the optimum is
+    // interior, so it must match the budget-only closed form
+    {
+        Problem p = randomProblem(12, 7);
+        for (double& r : p.returns) r = 0.0005 + 0.02 * (r - 0.0005);
+        auto expected = closedForm(p, 50.0);
+        double smallest = 1.0;
+        for (double v : expected) smallest = std::min(smallest, v);
+        OptimizationParameters interior = params;
+        interior.risk_aversion = 50.0;
+        ClassicalOptimizer optimizer(12, interior);
+        auto w = optimizer.optimize(p.returns, p.covariance);
+        report(smallest > 0.0 ? "interior 12 assets vs closed form"
+                              : "closed form not interior (bad fixture)",
+               smallest > 0.0 ? maxDifference(w, expected) : 1.0, 1e-7);
+    }
+
+    // Random books with some bounds active and some not: KKT conditions
+    for (size_t n : {100u, 500u}) {
+        Problem p = randomProblem(n, 11 + n);
+        OptimizationParameters bounded = params;
+        bounded.risk_aversion = kRiskAversion;
+        ClassicalOptimizer optimizer(n, bounded);
+        auto w = optimizer.optimize(p.returns, p.covariance);
+        size_t held = std::count_if(w.begin(), w.end(), [](double v) { return v > 1e-9; });
+        char label[96];
+        std::snprintf(label, sizeof(label), "random %zu assets KKT (%zu held, %d iters)", n, held,
+                      optimizer.lastStats().iterations_run);
+        report(label, kktResidual(p, kRiskAversion, w), 1e-6);
+    }
+
+    // The configured tolerance must end the solve well inside the budget,
+    // and a warm re-solve of a slightly moved market sooner still
+    {
+        Problem p = randomProblem(200, 17);
+        OptimizationParameters early{kRiskAversion, 1.0, 1000, 0.01};
+        early.convergence_tolerance = 1e-6;
+        early.warm_start = true;
+        ClassicalOptimizer optimizer(200, early);
+        optimizer.optimize(p.returns, p.covariance);
+        OptimizationStats cold = optimizer.lastStats();
+        for (double& r : p.returns) r *= 1.01;
+        auto w = optimizer.optimize(p.returns, p.covariance);
+        OptimizationStats warm = optimizer.lastStats();
+        std::printf("early stop at tolerance 1e-6: cold %d/%d iterations, warm %d/%d\n",
+                    cold.iterations_run, cold.iteration_budget, warm.iterations_run,
+                    warm.iteration_budget);
+        bool stopped = cold.converged && warm.converged &&
+                       cold.iterations_run < cold.iteration_budget / 2 &&
+                       warm.iterations_run < cold.iterations_run;
+        // The tolerance bounds the weight step, L * tolerance in gradient terms
+        report("early stop, warm re-solve KKT residual",
+               stopped ? kktResidual(p, kRiskAversion, w) : 1.0, 1e-2);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    if (args.has("check")) return check() ? 0 : 1;
+
+    const size_t n = static_cast<size_t>(args.get("assets", 500.0));
+    const int calls = static_cast<int>(args.get("calls", 20.0));
+    OptimizationParameters params{kRiskAversion, 1.0,
+                                  static_cast<int>(args.get("iterations", 1000.0)), 0.01};
+    params.convergence_tolerance = args.get("tolerance", 1e-6);
+    params.warm_start = true;
+
+    // Successive calls on a slowly drifting market, as the rebalance loop sees it
+    Problem p = randomProblem(n, 3);
+    std::mt19937_64 gen(5);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    ClassicalOptimizer optimizer(n, params);
+    std::vector<double> latencies;
+    int iterations = 0, converged = 0;
+    std::vector<double> w;
+    for (int c = 0; c < calls; ++c) {
+        for (double& r : p.returns) r += 1e-5 * noise(gen);
+        auto start = Clock::now();
+        w = optimizer.optimize(p.returns, p.covariance);
+        latencies.push_back(bench::millisecondsSince(start));
+        iterations += optimizer.lastStats().iterations_run;
+        converged += optimizer.lastStats().converged ? 1 : 0;
+    }
+    double first = latencies.front();
+    auto pct = bench::percentiles(latencies);
+    std::printf("%zu assets, %d calls, budget %d, tolerance %.0e\n", n, calls,
+                params.num_iterations, params.convergence_tolerance);
+    std::printf("cold call: %.2f ms; all calls p50 %.2f ms, p99 %.2f ms\n", first, pct.p50,
+                pct.p99);
+    std::printf("mean iterations %.1f, %d/%d converged early, final KKT residual %.2e\n",
+                double(iterations) / calls, converged, calls, kktResidual(p, kRiskAversion, w));
+    return 0;
+}
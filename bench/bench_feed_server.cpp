@@ -0,0 +1,226 @@
+// Local Beast WebSocket stand-in for the market data provider. It accepts
+// the feed's subscribe frames and streams ticks for the subscribed symbols
+// at a fixed rate per connection; by default it also drives a
+// MarketDataFeed against itself and reports what the feed kept up with.
+//
+//   bench_feed_server [--connections=2] [--symbols=500] [--rate=50000]
+//                     [--seconds=5] [--port=0]
+//   bench_feed_server --serve --port=9002 [--rate=50000]
+//
+// --rate is messages per second per connection (0 = as fast as the socket
+// takes them). --serve only runs the server, for pointing the full
+// application at ws://127.0.0.1:<port>/ws.
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "MarketIntegration.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+using tcp = boost::asio::ip::tcp;
+namespace websocket = boost::beast::websocket;
+
+namespace {
+
+std::atomic<bool> g_streaming{true};
+
+// One client connection, on its own io_context thread: a read loop that
+// collects subscriptions and a write loop that paces ticks for them
+class Session {
+public:
+    Session(double rate, uint64_t seed) : ws_(ioc_), rate_(rate), timer_(ioc_), gen_(seed) {}
+
+    // Accept into this, then run()
+    tcp::socket& socket() {
+        return boost::beast::get_lowest_layer(ws_).socket();
+    }
+
+    void run() {
+        thread_ = std::thread([this] {
+            try {
+                ws_.accept();
+                read();
+                ioc_.run();
+            } catch (const std::exception&) {
+                // The client went away
+            }
+        });
+    }
+
+    void join() {
+        if (thread_.joinable()) thread_.join();
+    }
+
+    uint64_t sent() const {
+        return sent_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Instrument {
+        std::string symbol;
+        double price;
+    };
+
+    void read() {
+        ws_.async_read(buffer_, [this](boost::system::error_code ec, size_t) {
+            if (ec) return;
+            auto frame = boost::beast::buffers_to_string(buffer_.data());
+            buffer_.consume(buffer_.size());
+            auto message = nlohmann::json::parse(frame, nullptr, false);
+            bool idle = instruments_.empty();
+            if (message.contains("symbols")) {
+                for (const auto& name : message["symbols"]) add(name.get<std::string>());
+            } else if (message.contains("symbol")) {
+                add(message["symbol"].get<std::string>());
+            }
+            if (idle && !instruments_.empty()) {
+                due_ = Clock::now();
+                write();
+            }
+            read();
+        });
+    }
+
+    void add(const std::string& symbol) {
+        instruments_.push_back({symbol, 50.0 + (10 * instruments_.size()) % 900});
+    }
+
+    void write() {
+        // Go quiet rather than close, so the feed does not reconnect; the
+        // session ends when the feed disconnects
+        if (!g_streaming.load(std::memory_order_relaxed)) return;
+        // Only wait when ahead of schedule, so high rates are not bound by
+        // timer resolution
+        if (rate_ > 0.0) {
+            due_ += std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate_));
+            if (due_ > Clock::now()) {
+                timer_.expires_at(due_);
+                timer_.async_wait([this](boost::system::error_code ec) {
+                    if (!ec) send();
+                });
+                return;
+            }
+        }
+        send();
+    }
+
+    void send() {
+        Instrument& instrument = instruments_[next_++ % instruments_.size()];
+        instrument.price *= 1.0 + 0.0002 * move_(gen_);
+        int n = std::snprintf(frame_, sizeof(frame_),
+                              "{\"symbol\":\"%s\",\"price\":%.2f,\"volume\":%d,"
+                              "\"bid\":%.2f,\"ask\":%.2f,\"lastUpdated\":%lld}",
+                              instrument.symbol.c_str(), instrument.price,
+                              static_cast<int>(100 * (1 + next_ % 50)), instrument.price - 0.01,
+                              instrument.price + 0.01,
+                              static_cast<long long>(next_));
+        ws_.async_write(boost::asio::buffer(frame_, n),
+                        [this](boost::system::error_code ec, size_t) {
+                            if (ec) return;
+                            sent_.fetch_add(1, std::memory_order_relaxed);
+                            write();
+                        });
+    }
+
+    boost::asio::io_context ioc_;
+    websocket::stream<boost::beast::tcp_stream> ws_;
+    double rate_;
+    boost::asio::steady_timer timer_;
+    std::mt19937_64 gen_;
+    std::normal_distribution<double> move_{0.0, 1.0};
+    boost::beast::flat_buffer buffer_;
+    std::vector<Instrument> instruments_;
+    Clock::time_point due_;
+    size_t next_ = 0;
+    char frame_[256];
+    std::atomic<uint64_t> sent_{0};
+    std::thread thread_;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    const bool serve = args.has("serve");
+    const size_t connections = static_cast<size_t>(args.get("connections", 2.0));
+    const size_t num_symbols = static_cast<size_t>(args.get("symbols", 500.0));
+    const double rate = args.get("rate", 50000.0);
+    const double seconds = args.get("seconds", 5.0);
+
+    boost::asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, {boost::asio::ip::make_address("127.0.0.1"),
+                                 static_cast<unsigned short>(args.get("port", 0.0))});
+    const std::string port = std::to_string(acceptor.local_endpoint().port());
+    std::printf("stand-in feed on ws://127.0.0.1:%s/ws, %.0f msg/s per connection\n",
+                port.c_str(), rate);
+
+    // Accept the feed's connections; in --serve mode keep accepting
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::thread acceptor_thread([&] {
+        for (size_t i = 0; serve || i < connections; ++i) {
+            auto session = std::make_unique<Session>(rate, 17 + i);
+            acceptor.accept(session->socket());
+            session->run();
+            sessions.push_back(std::move(session));
+        }
+    });
+    if (serve) {
+        acceptor_thread.join();
+        return 0;
+    }
+
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < num_symbols; ++i) {
+        char name[24];
+        std::snprintf(name, sizeof(name), "S%04zu", i);
+        symbols.push_back(name);
+    }
+
+    MarketDataFeed feed(num_symbols);
+    feed.connect("127.0.0.1", port, connections);
+    acceptor_thread.join();
+    feed.subscribe(symbols);
+
+    auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    g_streaming.store(false, std::memory_order_relaxed);
+    double elapsed_s = bench::millisecondsSince(start) / 1000.0;
+    // Let frames already on the wire arrive
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    uint64_t sent = 0;
+    for (const auto& session : sessions) sent += session->sent();
+    std::printf("%zu connections, %zu symbols, %.1f s, cold start %.1f ms\n", connections,
+                num_symbols, elapsed_s, feed.coldStartMs());
+    std::printf("%4s %12s %12s %10s %10s %12s %14s\n", "conn", "messages", "msg/s", "MB/s",
+                "fallback", "max us", "max pending B");
+    uint64_t received = 0;
+    auto stats = feed.connectionStats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& s = stats[i];
+        received += s.messages;
+        std::printf("%4zu %12llu %12.0f %10.1f %10llu %12.1f %14zu\n", i,
+                    static_cast<unsigned long long>(s.messages), s.messages / elapsed_s,
+                    s.bytes / 1e6 / elapsed_s, static_cast<unsigned long long>(s.fallback_parses),
+                    s.max_handler_us, s.max_pending_bytes);
+    }
+    std::printf("sent %llu, received %llu (%.0f msg/s total)\n",
+                static_cast<unsigned long long>(sent), static_cast<unsigned long long>(received),
+                received / elapsed_s);
+
+    feed.stop();
+    for (auto& session : sessions) session->join();
+    return 0;
+}
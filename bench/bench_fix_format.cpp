@@ -0,0 +1,178 @@
+// Encode-only cost of an order's variable fields. The new path patches the
+// ClOrdID, OrderQty and Price values into a prebuilt tag=value body with
+// fix_format. The old path built every field generically, numbers through
+// std::to_string as FIX::OrderQty(double) and friends did.
+//
+//   bench_fix_format [--orders=1000000] [--symbols=500]
+//   bench_fix_format --check     (encoder round trips, exit status only)
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "FixFormat.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+constexpr char kSoh = '\x01';
+constexpr int kQtyDecimals = 4;    // As in FixTrading
+constexpr int kPriceDecimals = 6;
+
+struct Order {
+    size_t symbol;
+    char side;
+    double quantity;
+    double price;
+};
+
+// Static fields of a NewOrderSingle, built once per symbol and side
+std::string templateFor(const std::string& symbol, char side) {
+    return std::string("35=D") + kSoh + "55=" + symbol + kSoh + "54=" + side + kSoh + "40=2" +
+           kSoh + "59=0" + kSoh;
+}
+
+size_t appendTag(char* out, const char* tag) {
+    size_t length = std::strlen(tag);
+    std::memcpy(out, tag, length);
+    return length;
+}
+
+// Template copy plus the three patched values, no allocation
+size_t encodeTemplated(char* out, const std::string& prefix, uint64_t id, const Order& order) {
+    size_t length = prefix.size();
+    std::memcpy(out, prefix.data(), length);
+    length += appendTag(out + length, "11=ORD");
+    length += fix_format::formatUnsigned(out + length, id);
+    out[length++] = kSoh;
+    length += appendTag(out + length, "38=");
+    length += fix_format::formatFixed(out + length, order.quantity, kQtyDecimals);
+    out[length++] = kSoh;
+    length += appendTag(out + length, "44=");
+    length += fix_format::formatFixed(out + length, order.price, kPriceDecimals);
+    out[length++] = kSoh;
+    return length;
+}
+
+// Every field converted and appended on each order
+std::string encodeGeneric(const std::string& symbol, uint64_t id, const Order& order) {
+    std::string body;
+    body += std::string("35=D") + kSoh;
+    body += "11=" + ("ORD" + std::to_string(id)) + kSoh;
+    body += "55=" + symbol + kSoh;
+    body += std::string("54=") + order.side + kSoh;
+    body += "38=" + std::to_string(order.quantity) + kSoh;
+    body += "44=" + std::to_string(order.price) + kSoh;
+    body += std::string("40=2") + kSoh;
+    body += std::string("59=0") + kSoh;
+    return body;
+}
+
+std::vector<Order> makeOrders(size_t count, size_t symbols) {
+    std::mt19937_64 gen(8);
+    std::uniform_int_distribution<size_t> symbol(0, symbols - 1);
+    std::uniform_real_distribution<double> quantity(1.0, 2000.0), price(1.0, 900.0);
+    std::vector<Order> orders(count);
+    for (size_t i = 0; i < count; ++i) {
+        orders[i] = {symbol(gen), i % 2 ? '2' : '1', std::round(quantity(gen)),
+                     std::round(price(gen) * 100.0) / 100.0};
+    }
+    return orders;
+}
+
+bool check() {
+    bool ok = true;
+    std::mt19937_64 gen(4);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    char out[fix_format::kMaxNumberLength + 1];
+    for (int i = 0; i < 200000 && ok; ++i) {
+        double v = i < 1000 ? (i - 500) * 0.01 : value(gen);
+        for (int decimals : {0, 2, kQtyDecimals, kPriceDecimals}) {
+            size_t length = fix_format::formatFixed(out, v, decimals);
+            out[length] = '\0';
+            double scale = std::pow(10.0, decimals);
+            double expected = std::round(v * scale) / scale;
+            if (std::abs(std::strtod(out, nullptr) - expected) > 1e-9 * std::max(1.0, std::abs(v))) {
+                std::printf("formatFixed(%.17g, %d) = %s\n", v, decimals, out);
+                ok = false;
+            }
+        }
+        uint64_t n = gen() >> (i % 64);
+        size_t length = fix_format::formatUnsigned(out, n);
+        if (std::string(out, length) != std::to_string(n)) {
+            std::printf("formatUnsigned(%llu) = %.*s\n", static_cast<unsigned long long>(n),
+                        static_cast<int>(length), out);
+            ok = false;
+        }
+    }
+    std::printf("fix_format encoders %s\n", ok ? "round-trip" : "FAILED");
+    return ok;
+}
+
+void report(const char* label, double loop_ms, std::vector<double>& samples, size_t bytes) {
+    auto pct = bench::percentiles(samples);
+    std::printf("%-26s %6.2f M orders/s  p50 %6.1f  p99 %6.1f  p99.9 %7.1f ns  %5.1f bytes/order\n",
+                label, samples.size() / loop_ms / 1e3, pct.p50, pct.p99, pct.p999,
+                double(bytes) / samples.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    if (args.has("check")) return check() ? 0 : 1;
+
+    const size_t count = static_cast<size_t>(args.get("orders", 1e6));
+    const size_t num_symbols = static_cast<size_t>(args.get("symbols", 500.0));
+    auto orders = makeOrders(count, num_symbols);
+    std::vector<std::string> symbols(num_symbols), templates(2 * num_symbols);
+    for (size_t s = 0; s < num_symbols; ++s) {
+        symbols[s] = "SYM" + std::to_string(s);
+        templates[2 * s] = templateFor(symbols[s], '1');
+        templates[2 * s + 1] = templateFor(symbols[s], '2');
+    }
+
+    // Throughput from an untimed loop, percentiles from a per-order timed one
+    std::vector<double> samples(count);
+    char buffer[256];
+    size_t bytes = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        const Order& order = orders[i];
+        bytes += encodeTemplated(buffer, templates[2 * order.symbol + (order.side == '2')], i + 1,
+                                 order);
+        bench::keep(buffer);
+    }
+    double loop_ms = bench::millisecondsSince(start);
+    for (size_t i = 0; i < count; ++i) {
+        const Order& order = orders[i];
+        auto t0 = Clock::now();
+        encodeTemplated(buffer, templates[2 * order.symbol + (order.side == '2')], i + 1, order);
+        bench::keep(buffer);
+        samples[i] = bench::nanosecondsBetween(t0, Clock::now());
+    }
+    report("template + fix_format", loop_ms, samples, bytes);
+
+    bytes = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        std::string body = encodeGeneric(symbols[orders[i].symbol], i + 1, orders[i]);
+        bytes += body.size();
+        bench::keep(body);
+    }
+    loop_ms = bench::millisecondsSince(start);
+    for (size_t i = 0; i < count; ++i) {
+        auto t0 = Clock::now();
+        std::string body = encodeGeneric(symbols[orders[i].symbol], i + 1, orders[i]);
+        bench::keep(body);
+        samples[i] = bench::nanosecondsBetween(t0, Clock::now());
+    }
+    report("generic + std::to_string", loop_ms, samples, bytes);
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Orders per second and per-order latency of serializing a NewOrderSingle
+// through QuickFIX: the per-symbol template with ClOrdID, OrderQty and
+// Price patched in as FixTrading sends it, against building the message
+// field by field with FIX::OrderQty(double) and FIX::Price(double).
+// Both end in Message::toString, which is what Session::send serializes.
+//
+//   bench_fix_orders [--orders=200000] [--symbols=500]
+
+#include <quickfix/Message.h>
+#include <quickfix/fix44/NewOrderSingle.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "FixFormat.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+constexpr int kQtyDecimals = 4;    // As in FixTrading
+constexpr int kPriceDecimals = 6;
+
+struct Order {
+    size_t symbol;
+    char side;
+    double quantity;
+    double price;
+};
+
+std::vector<Order> makeOrders(size_t count, size_t symbols) {
+    std::mt19937_64 gen(8);
+    std::uniform_int_distribution<size_t> symbol(0, symbols - 1);
+    std::uniform_real_distribution<double> quantity(1.0, 2000.0), price(1.0, 900.0);
+    std::vector<Order> orders(count);
+    for (size_t i = 0; i < count; ++i) {
+        orders[i] = {symbol(gen), i % 2 ? '2' : '1', std::round(quantity(gen)),
+                     std::round(price(gen) * 100.0) / 100.0};
+    }
+    return orders;
+}
+
+void setHeader(FIX::Message& message) {
+    message.getHeader().setField(FIX::BeginString("FIX.4.4"));
+    message.getHeader().setField(FIX::SenderCompID("QUANTUM_ALLOC"));
+    message.getHeader().setField(FIX::TargetCompID("BROKER"));
+}
+
+void report(const char* label, double loop_ms, std::vector<double>& samples) {
+    auto pct = bench::percentiles(samples);
+    std::printf("%-24s %8.0f orders/s  p50 %7.1f  p99 %7.1f  p99.9 %8.1f ns\n", label,
+                samples.size() * 1000.0 / loop_ms, pct.p50, pct.p99, pct.p999);
+}
+
+// Runs encode over every order twice: untimed for throughput, then timed
+// per order for percentiles
+template <typename Encode>
+void measure(const char* label, const std::vector<Order>& orders, Encode&& encode) {
+    std::string wire;
+    auto start = Clock::now();
+    for (size_t i = 0; i < orders.size(); ++i) encode(orders[i], i + 1, wire);
+    double loop_ms = bench::millisecondsSince(start);
+    std::vector<double> samples(orders.size());
+    for (size_t i = 0; i < orders.size(); ++i) {
+        auto t0 = Clock::now();
+        encode(orders[i], i + 1, wire);
+        samples[i] = bench::nanosecondsBetween(t0, Clock::now());
+    }
+    bench::keep(wire);
+    report(label, loop_ms, samples);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    const size_t count = static_cast<size_t>(args.get("orders", 200000.0));
+    const size_t num_symbols = static_cast<size_t>(args.get("symbols", 500.0));
+    auto orders = makeOrders(count, num_symbols);
+    std::vector<std::string> symbols(num_symbols);
+    for (size_t s = 0; s < num_symbols; ++s) symbols[s] = "SYM" + std::to_string(s);
+
+    // One prebuilt message per symbol and side, as FixTrading::orderTemplate
+    std::vector<std::unique_ptr<FIX44::NewOrderSingle>> templates(2 * num_symbols);
+    for (size_t s = 0; s < num_symbols; ++s) {
+        for (char side : {FIX::Side_BUY, FIX::Side_SELL}) {
+            auto message = std::make_unique<FIX44::NewOrderSingle>();
+            setHeader(*message);
+            message->setField(FIX::Symbol(symbols[s]));
+            message->setField(FIX::Side(side));
+            message->setField(FIX::OrdType(FIX::OrdType_LIMIT));
+            message->setField(FIX::TimeInForce(FIX::TimeInForce_DAY));
+            templates[2 * s + (side == FIX::Side_SELL)] = std::move(message);
+        }
+    }
+
+    measure("template + fix_format", orders, [&](const Order& order, uint64_t id, std::string& wire) {
+        FIX44::NewOrderSingle& message = *templates[2 * order.symbol + (order.side == FIX::Side_SELL)];
+        char buffer[fix_format::kMaxNumberLength];
+        std::memcpy(buffer, "ORD", 3);
+        message.setField(FIX::FIELD::ClOrdID,
+                         std::string(buffer, 3 + fix_format::formatUnsigned(buffer + 3, id)));
+        message.setField(FIX::FIELD::OrderQty,
+                         std::string(buffer, fix_format::formatFixed(buffer, order.quantity,
+                                                                     kQtyDecimals)));
+        message.setField(FIX::FIELD::Price,
+                         std::string(buffer, fix_format::formatFixed(buffer, order.price,
+                                                                     kPriceDecimals)));
+        message.toString(wire);
+    });
+
+    measure("field by field", orders, [&](const Order& order, uint64_t id, std::string& wire) {
+        FIX44::NewOrderSingle message;
+        setHeader(message);
+        message.setField(FIX::ClOrdID("ORD" + std::to_string(id)));
+        message.setField(FIX::Symbol(symbols[order.symbol]));
+        message.setField(FIX::Side(order.side));
+        message.setField(FIX::OrderQty(order.quantity));
+        message.setField(FIX::Price(order.price));
+        message.setField(FIX::OrdType(FIX::OrdType_LIMIT));
+        message.setField(FIX::TimeInForce(FIX::TimeInForce_DAY));
+        message.toString(wire);
+    });
+    return 0;
+}
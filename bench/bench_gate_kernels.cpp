@@ -0,0 +1,250 @@
+// Gate kernels and QuantumCircuit against the original per-index
+// std::complex loops: numerical equivalence and speed. The check also
+// covers the dispatched vector kernels.
+//
+//   bench_gate_kernels [--qubits=21] [--layers=2]
+//   bench_gate_kernels --check     (small circuits, exit status only)
+
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "QuantumOptimizer.hpp"
+#include "StateVectorKernels.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+// The circuit as it was before the kernels: every gate scans all 2^n
+// amplitudes with a bit test per index
+class ReferenceCircuit {
+public:
+    explicit ReferenceCircuit(size_t num_qubits) : num_qubits_(num_qubits) {
+        state_.resize(size_t(1) << num_qubits, 0.0);
+        state_[0] = 1.0;
+    }
+
+    void hadamard(size_t qubit) {
+        const std::complex<double> h = 1.0 / std::sqrt(2.0);
+        const size_t bit = size_t(1) << qubit;
+        for (size_t i = 0; i < state_.size(); i++) {
+            if (i & bit) {
+                std::complex<double> temp = state_[i];
+                state_[i] = h * (state_[i ^ bit] - temp);
+                state_[i ^ bit] = h * (temp + state_[i ^ bit]);
+            }
+        }
+    }
+
+    void phase(size_t qubit, double angle) {
+        std::complex<double> phase = std::polar(1.0, angle);
+        const size_t bit = size_t(1) << qubit;
+        for (size_t i = 0; i < state_.size(); i++) {
+            if (i & bit) state_[i] *= phase;
+        }
+    }
+
+    void controlled_phase(size_t control, size_t target, double angle) {
+        std::complex<double> phase = std::polar(1.0, angle);
+        const size_t mask = (size_t(1) << control) | (size_t(1) << target);
+        for (size_t i = 0; i < state_.size(); i++) {
+            if ((i & mask) == mask) state_[i] *= phase;
+        }
+    }
+
+    std::vector<double> measure() const {
+        std::vector<double> probabilities(num_qubits_);
+        for (size_t i = 0; i < state_.size(); i++) {
+            double prob = std::norm(state_[i]);
+            for (size_t q = 0; q < num_qubits_; q++) {
+                if (i & (size_t(1) << q)) probabilities[q] += prob;
+            }
+        }
+        return probabilities;
+    }
+
+    const std::vector<std::complex<double>>& state() const { return state_; }
+
+private:
+    size_t num_qubits_;
+    std::vector<std::complex<double>> state_;
+};
+
+// Split-array state driven straight through one kernel table
+template <typename Real>
+struct KernelState {
+    KernelState(size_t num_qubits, const kernels::GateKernels<Real>& table)
+        : re(size_t(1) << num_qubits, Real(0)), im(re.size(), Real(0)), k(table) {
+        re[0] = Real(1);
+    }
+
+    void hadamard(size_t qubit) {
+        k.hadamard(re.data(), im.data(), size_t(1) << qubit, 0, re.size() / 2);
+    }
+
+    void phase(size_t qubit, double angle) {
+        apply(size_t(1) << qubit, angle);
+    }
+
+    void controlled_phase(size_t control, size_t target, double angle) {
+        apply((size_t(1) << control) | (size_t(1) << target), angle);
+    }
+
+    void apply(size_t mask, double angle) {
+        k.phase(re.data(), im.data(), mask, static_cast<Real>(std::cos(angle)),
+                static_cast<Real>(std::sin(angle)), 0, kernels::compressedSize(re.size(), mask));
+    }
+
+    kernels::AlignedVector<Real> re, im;
+    const kernels::GateKernels<Real>& k;
+};
+
+double angleFor(size_t a, size_t b) {
+    return 0.1 + 0.37 * a - 0.11 * b;
+}
+
+// One optimizer-style layer: H on every qubit, then a phase per qubit and
+// a controlled phase per pair
+template <typename Circuit>
+void layer(Circuit& circuit, size_t n) {
+    for (size_t q = 0; q < n; ++q) circuit.hadamard(q);
+    for (size_t q = 0; q < n; ++q) circuit.phase(q, angleFor(q, q));
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = a + 1; b < n; ++b) circuit.controlled_phase(a, b, angleFor(a, b));
+    }
+}
+
+template <typename Real>
+double maxDifference(const ReferenceCircuit& reference, const KernelState<Real>& state) {
+    double worst = 0.0;
+    for (size_t i = 0; i < state.re.size(); ++i) {
+        worst = std::max(worst, std::abs(reference.state()[i] -
+                                         std::complex<double>(state.re[i], state.im[i])));
+    }
+    return worst;
+}
+
+double maxDifference(const std::vector<double>& a, const std::vector<double>& b) {
+    double worst = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) worst = std::max(worst, std::abs(a[i] - b[i]));
+    return worst;
+}
+
+// Every stride and every pair on small circuits, for each kernel table
+bool check() {
+    bool ok = true;
+    for (size_t n = 1; n <= 11; ++n) {
+        ReferenceCircuit reference(n);
+        KernelState<double> scalar(n, kernels::scalarKernels<double>());
+        KernelState<double> best(n, kernels::gateKernels<double>());
+        KernelState<float> best_float(n, kernels::gateKernels<float>());
+        for (int l = 0; l < 2; ++l) {
+            layer(reference, n);
+            layer(scalar, n);
+            layer(best, n);
+            layer(best_float, n);
+        }
+        double e_scalar = maxDifference(reference, scalar);
+        double e_best = maxDifference(reference, best);
+        double e_float = maxDifference(reference, best_float);
+
+        QuantumOptimizer::QuantumCircuit circuit(n);
+        layer(circuit, n);
+        layer(circuit, n);
+        double e_circuit = maxDifference(reference.measure(), circuit.measure());
+
+        bool pass = e_scalar < 1e-12 && e_best < 1e-12 && e_float < 1e-5 && e_circuit < 1e-12;
+        if (!pass) {
+            std::printf("n=%zu mismatch: scalar %.3g %s %.3g float %.3g circuit %.3g\n", n,
+                        e_scalar, kernels::gateKernels<double>().name, e_best, e_float, e_circuit);
+        }
+        ok = ok && pass;
+    }
+    std::printf("gate kernels (%s) %s the reference loops\n", kernels::gateKernels<double>().name,
+                ok ? "match" : "DO NOT match");
+
+    // Dispatched axpy against the scalar loop, at every tail length and an
+    // unaligned start
+    double e_axpy = 0.0;
+    for (size_t n = 0; n <= 40; ++n) {
+        std::vector<double> x(n + 1), y(n + 1), expected(n + 1);
+        for (size_t i = 0; i <= n; ++i) {
+            x[i] = std::sin(1.0 + i);
+            y[i] = expected[i] = std::cos(0.3 * i);
+        }
+        kernels::vectorKernels().axpy(0.7, x.data() + 1, y.data() + 1, n);
+        for (size_t i = 1; i <= n; ++i) expected[i] += 0.7 * x[i];
+        e_axpy = std::max(e_axpy, maxDifference(expected, y));
+    }
+    std::printf("axpy (%s) max difference %.2e\n", kernels::vectorKernels().name, e_axpy);
+    ok = ok && e_axpy < 1e-14;
+    return ok;
+}
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = Clock::now();
+    fn();
+    return bench::millisecondsSince(start);
+}
+
+// Best of a few runs; the gates are unitary, so repeating them is harmless
+template <typename Fn>
+double bestMs(Fn&& fn, int runs = 3) {
+    double best = timeMs(fn);
+    for (int r = 1; r < runs; ++r) best = std::min(best, timeMs(fn));
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    if (args.has("check")) return check() ? 0 : 1;
+
+    const size_t n = static_cast<size_t>(args.get("qubits", 21.0));
+    const int layers = static_cast<int>(args.get("layers", 2.0));
+    std::printf("%zu qubits, %d layers, kernels: %s\n", n, layers,
+                kernels::gateKernels<double>().name);
+
+    // Per gate type: reference loop vs scalar stride loop vs dispatched SIMD
+    ReferenceCircuit reference(n);
+    KernelState<double> scalar(n, kernels::scalarKernels<double>());
+    KernelState<double> best(n, kernels::gateKernels<double>());
+    std::printf("%-18s %12s %12s %12s %9s\n", "gate (all qubits)", "reference ms", "scalar ms",
+                "simd ms", "speedup");
+    auto row = [&](const char* label, auto&& apply) {
+        double t_ref = bestMs([&] { apply(reference); });
+        double t_scalar = bestMs([&] { apply(scalar); });
+        double t_best = bestMs([&] { apply(best); });
+        std::printf("%-18s %12.1f %12.1f %12.1f %8.1fx\n", label, t_ref, t_scalar, t_best,
+                    t_ref / t_best);
+    };
+    row("hadamard", [&](auto& c) { for (size_t q = 0; q < n; ++q) c.hadamard(q); });
+    row("phase", [&](auto& c) { for (size_t q = 0; q < n; ++q) c.phase(q, angleFor(q, q)); });
+    row("controlled_phase", [&](auto& c) {
+        for (size_t q = 0; q + 1 < n; ++q) c.controlled_phase(q, q + 1, angleFor(q, q + 1));
+    });
+    std::printf("max |amplitude difference| vs reference: scalar %.2e, simd %.2e\n",
+                maxDifference(reference, scalar), maxDifference(reference, best));
+
+    // Whole layers plus readout through QuantumCircuit (fused diagonals)
+    ReferenceCircuit layered(n);
+    QuantumOptimizer::QuantumCircuit circuit(n);
+    std::vector<double> expected, actual;
+    double t_ref = timeMs([&] {
+        for (int l = 0; l < layers; ++l) layer(layered, n);
+        expected = layered.measure();
+    });
+    double t_circuit = timeMs([&] {
+        for (int l = 0; l < layers; ++l) layer(circuit, n);
+        actual = circuit.measure();
+    });
+    std::printf("circuit layers + measure: reference %.1f ms, QuantumCircuit %.1f ms, "
+                "%.1fx, max marginal difference %.2e\n",
+                t_ref, t_circuit, t_ref / t_circuit, maxDifference(expected, actual));
+    return 0;
+}
@@ -0,0 +1,93 @@
+// QuantumCircuit::measure() against the original O(n 2^n) marginal loop
+// at 16, 20 and 24 qubits.
+//
+//   bench_measure [--qubits=16,20,24] [--threads=0] [--repeats=5]
+
+#include <complex>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "QuantumOptimizer.hpp"
+#include "ThreadPool.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+// The readout loop measure() replaced
+std::vector<double> referenceMeasure(const std::vector<std::complex<double>>& state, size_t n) {
+    std::vector<double> probabilities(n);
+    for (size_t i = 0; i < state.size(); i++) {
+        double prob = std::norm(state[i]);
+        for (size_t q = 0; q < n; q++) {
+            if (i & (size_t(1) << q)) probabilities[q] += prob;
+        }
+    }
+    return probabilities;
+}
+
+// A state with distinct marginals that has to be simulated: superposition,
+// phases, then a second round of hadamards
+void prepare(QuantumOptimizer::QuantumCircuit& circuit, size_t n) {
+    for (size_t q = 0; q < n; ++q) circuit.hadamard(q);
+    for (size_t q = 0; q < n; ++q) circuit.phase(q, 0.3 + 0.1 * q);
+    for (size_t q = 0; q + 1 < n; ++q) circuit.controlled_phase(q, q + 1, 0.7 - 0.05 * q);
+    for (size_t q = 0; q < n; q += 2) circuit.hadamard(q);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    const int repeats = static_cast<int>(args.get("repeats", 5.0));
+    ThreadPool pool(static_cast<size_t>(args.get("threads", 0.0)));
+
+    std::vector<size_t> sizes;
+    std::stringstream list(args.get("qubits", std::string("16,20,24")));
+    for (std::string item; std::getline(list, item, ',');) sizes.push_back(std::stoul(item));
+
+    std::printf("%d threads\n", static_cast<int>(pool.size()));
+    std::printf("%7s %14s %14s %12s %14s %14s %12s\n", "qubits", "reference ms", "measure ms",
+                "speedup", "cached us", "subset(4) ms", "max diff");
+    for (size_t n : sizes) {
+        QuantumOptimizer::QuantumCircuit circuit(n);
+        circuit.setThreadPool(&pool);
+        prepare(circuit, n);
+
+        std::vector<std::complex<double>> state(size_t(1) << n);
+        for (size_t i = 0; i < state.size(); ++i) state[i] = circuit.amplitude(i);
+
+        double reference_ms = 1e300, measure_ms = 1e300, subset_ms = 1e300, cached_us = 1e300;
+        std::vector<double> expected, actual;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = Clock::now();
+            expected = referenceMeasure(state, n);
+            reference_ms = std::min(reference_ms, bench::millisecondsSince(start));
+
+            // A hadamard pair is the identity but invalidates the cached marginals
+            circuit.hadamard(1);
+            circuit.hadamard(1);
+            start = Clock::now();
+            actual = circuit.measure();
+            measure_ms = std::min(measure_ms, bench::millisecondsSince(start));
+
+            start = Clock::now();
+            bench::keep(circuit.measure());
+            cached_us = std::min(cached_us, 1e3 * bench::millisecondsSince(start));
+
+            circuit.hadamard(1);
+            circuit.hadamard(1);
+            start = Clock::now();
+            bench::keep(circuit.measure({0, n / 3, n / 2, n - 1}));
+            subset_ms = std::min(subset_ms, bench::millisecondsSince(start));
+        }
+
+        double worst = 0.0;
+        for (size_t q = 0; q < n; ++q) worst = std::max(worst, std::abs(expected[q] - actual[q]));
+        std::printf("%7zu %14.2f %14.2f %11.1fx %14.2f %14.2f %12.2e\n", n, reference_ms,
+                    measure_ms, reference_ms / measure_ms, cached_us, subset_ms, worst);
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// PreTradeRiskGate::check() + release() latency on the order path, alone
+// and with a FIX-thread stand-in calling onFill() on the same symbols.
+//
+//   bench_risk_gate [--orders=1000000] [--symbols=500]
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "RiskGate.hpp"
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+struct Order {
+    SymbolId id;
+    char side;
+    double quantity;
+    double price;
+};
+
+std::vector<Order> makeOrders(size_t count, size_t symbols) {
+    std::mt19937_64 gen(3);
+    std::uniform_int_distribution<SymbolId> symbol(0, static_cast<SymbolId>(symbols - 1));
+    std::uniform_real_distribution<double> quantity(1.0, 500.0), price(10.0, 500.0);
+    std::vector<Order> orders(count);
+    for (size_t i = 0; i < count; ++i) {
+        orders[i] = {symbol(gen), i % 2 ? '2' : '1', std::round(quantity(gen)), price(gen)};
+    }
+    return orders;
+}
+
+// Per check + release pair, in nanoseconds
+std::vector<double> run(PreTradeRiskGate& gate, const std::vector<Order>& orders,
+                        size_t& accepted) {
+    std::vector<double> samples;
+    samples.reserve(orders.size());
+    accepted = 0;
+    for (const Order& order : orders) {
+        auto start = Clock::now();
+        RiskCheck result = gate.check(order.id, order.side, order.quantity, order.price);
+        if (result == RiskCheck::Accepted) {
+            gate.release(order.id, order.side, order.quantity, order.price);
+        }
+        auto end = Clock::now();
+        samples.push_back(bench::nanosecondsBetween(start, end));
+        accepted += result == RiskCheck::Accepted;
+    }
+    return samples;
+}
+
+void report(const char* label, std::vector<double>& samples, size_t accepted, double overhead) {
+    double total = 0.0;
+    for (double s : samples) total += s;
+    auto pct = bench::percentiles(samples);
+    std::printf("%-22s mean %6.1f  p50 %6.1f  p99 %7.1f  p99.9 %8.1f  max %9.1f ns  "
+                "(%zu/%zu accepted, clock overhead %.1f ns)\n",
+                label, total / samples.size(), pct.p50, pct.p99, pct.p999, pct.max, accepted,
+                samples.size(), overhead);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    const size_t count = static_cast<size_t>(args.get("orders", 1e6));
+    const size_t symbols = static_cast<size_t>(args.get("symbols", 500.0));
+
+    // Loose limits so every order takes the full accept path
+    RiskLimits limits;
+    limits.capital = 1e12;
+    limits.max_position = 0.5;
+    limits.max_daily_turnover = 1e6;
+    limits.max_leverage = 10.0;
+    limits.stop_loss = 0.5;
+    PreTradeRiskGate gate(symbols, limits);
+    auto orders = makeOrders(count, symbols);
+
+    // What two back-to-back clock reads cost on their own
+    std::vector<double> empty(count / 10);
+    for (double& e : empty) {
+        auto start = Clock::now();
+        e = bench::nanosecondsBetween(start, Clock::now());
+    }
+    double overhead = bench::percentiles(empty).p50;
+
+    size_t accepted = 0;
+    run(gate, orders, accepted);  // Warm the slots
+    auto samples = run(gate, orders, accepted);
+    report("single thread", samples, accepted, overhead);
+
+    // A fill stream on the same symbols, alternating sides so positions
+    // stay bounded: every fill is a read-modify-write on a slot the checks
+    // read and the global totals they test against
+    std::atomic<bool> filling{true};
+    std::atomic<uint64_t> fills{0};
+    std::thread fix_thread([&] {
+        size_t i = 0;
+        while (filling.load(std::memory_order_relaxed)) {
+            const Order& order = orders[i++ % orders.size()];
+            gate.onFill(order.id, order.side, 1.0, order.price);
+            fills.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    auto start = Clock::now();
+    samples = run(gate, orders, accepted);
+    double seconds = bench::millisecondsSince(start) / 1000.0;
+    filling.store(false, std::memory_order_relaxed);
+    fix_thread.join();
+    report("with onFill writer", samples, accepted, overhead);
+    std::printf("writer: %.2f M fills/s alongside, %u hardware threads\n",
+                fills.load() / seconds / 1e6, std::thread::hardware_concurrency());
+    return 0;
+}
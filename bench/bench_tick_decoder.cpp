@@ -0,0 +1,210 @@
+// TickDecoder on an IEX-style corpus (TOPS/last-sale fields around the
+// five the feed uses), against nlohmann::json when it is available.
+//
+//   bench_tick_decoder [--messages=200000] [--repeats=5] [--corpus=file.ndjson]
+//   bench_tick_decoder --check     (decoded fields and rejections, exit status only)
+//
+// --corpus replays a captured feed, one JSON message per line.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "BenchUtil.hpp"
+#include "TickDecoder.hpp"
+
+#if __has_include(<nlohmann/json.hpp>)
+#include <nlohmann/json.hpp>
+#define QUARTZ_BENCH_NLOHMANN 1
+#endif
+
+using namespace quantum_allocation;
+using bench::Clock;
+
+namespace {
+
+struct Expected {
+    std::string symbol;
+    double price, volume, bid, ask;
+};
+
+// The double a two-decimal price parses back to
+double cents(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2f", value);
+    return std::strtod(text, nullptr);
+}
+
+// Messages shaped like IEX TOPS quotes: the fields TickDecoder reads plus
+// the ones it skips (strings, sizes, epoch timestamps, a nested object,
+// literals), in varying order and spacing
+std::vector<std::string> generateCorpus(size_t count, std::vector<Expected>* expected) {
+    static const char* symbols[] = {"AAPL", "MSFT", "AMZN", "GOOGL", "META", "NVDA", "TSLA",
+                                    "JPM",  "V",    "XOM",  "BRK.B", "SPY",  "QQQ",  "IWM"};
+    static const char* sectors[] = {"technologyhardwareequipment", "softwareservices",
+                                    "retailing", "energy", "banks", "diversifiedfinancials"};
+    std::mt19937_64 gen(2024);
+    std::uniform_real_distribution<double> price(5.0, 900.0);
+    std::uniform_int_distribution<int> size(1, 5000);
+    std::vector<std::string> corpus;
+    corpus.reserve(count);
+    char buffer[512];
+    for (size_t m = 0; m < count; ++m) {
+        const char* symbol = symbols[m % (sizeof(symbols) / sizeof(symbols[0]))];
+        double last = cents(price(gen));
+        double bid = cents(last - 0.01), ask = cents(last + 0.01);
+        double volume = size(gen) * 100.0;
+        long long time = 1700000000000LL + static_cast<long long>(m) * 7;
+        int n;
+        switch (m % 3) {
+        case 0:
+            n = std::snprintf(buffer, sizeof(buffer),
+                "{\"symbol\":\"%s\",\"sector\":\"%s\",\"securityType\":\"cs\",\"bid\":%.2f,"
+                "\"bidSize\":%d,\"ask\":%.2f,\"askSize\":%d,\"lastUpdated\":%lld,"
+                "\"price\":%.2f,\"lastSaleSize\":%d,\"lastSaleTime\":%lld,\"volume\":%.0f,"
+                "\"marketPercent\":0.0%d}",
+                symbol, sectors[m % 6], bid, size(gen), ask, size(gen), time, last, size(gen),
+                time - 3, volume, size(gen));
+            break;
+        case 1:
+            n = std::snprintf(buffer, sizeof(buffer),
+                "{\"price\":%.2f,\"volume\":%.0f,\"symbol\":\"%s\",\"bid\":%.2f,"
+                "\"ask\":%.2f,\"venue\":{\"mic\":\"IEXG\",\"halted\":false,\"tiers\":[1,2,3]},"
+                "\"seq\":%zu}",
+                last, volume, symbol, bid, ask, m);
+            break;
+        default:
+            n = std::snprintf(buffer, sizeof(buffer),
+                " {\"symbol\": \"%s\", \"price\": %.2f, \"volume\": %.0f,\n"
+                "  \"bid\": %.2f, \"ask\": %.2f, \"isUSMarketOpen\": true, \"flags\": null}\n",
+                symbol, last, volume, bid, ask);
+            break;
+        }
+        corpus.emplace_back(buffer, n);
+        if (expected) expected->push_back({symbol, last, volume, bid, ask});
+    }
+    return corpus;
+}
+
+std::vector<std::string> loadCorpus(const std::string& path) {
+    std::vector<std::string> corpus;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) {
+        if (!line.empty()) corpus.push_back(line);
+    }
+    return corpus;
+}
+
+bool check() {
+    bool ok = true;
+    std::vector<Expected> expected;
+    auto corpus = generateCorpus(3000, &expected);
+    size_t mismatches = 0;
+    for (size_t m = 0; m < corpus.size(); ++m) {
+        Tick tick;
+        const Expected& e = expected[m];
+        bool decoded = TickDecoder::decode(corpus[m].data(), corpus[m].size(), tick);
+        if (!decoded || tick.symbol != e.symbol || tick.price != e.price ||
+            tick.volume != e.volume || tick.bid != e.bid || tick.ask != e.ask) {
+            if (mismatches++ < 5) std::printf("mismatch: %s\n", corpus[m].c_str());
+        }
+    }
+    ok = mismatches == 0;
+
+    // Everything here must go to the fallback parser
+    const std::string base = R"({"symbol":"AAPL","price":1,"volume":2,"bid":3,"ask":4})";
+    const std::string rejected[] = {
+        base + "x",
+        base + " {}",
+        base + base,
+        base + "}",
+        R"({"symbol":"A\"B","price":1,"volume":2,"bid":3,"ask":4})",
+        R"({"symbol":"AAPL","price":1,"volume":2,"bid":3})",
+        R"({"symbol":"AAPL","price":1,"volume":2,"bid":3,"ask":})",
+        R"({"symbol":"AAPL","price":1 "volume":2,"bid":3,"ask":4})",
+        "{}",
+        "",
+    };
+    for (const std::string& message : rejected) {
+        Tick tick;
+        if (TickDecoder::decode(message.data(), message.size(), tick)) {
+            std::printf("accepted: %s\n", message.c_str());
+            ok = false;
+        }
+    }
+    const std::string accepted[] = {
+        base + " \r\n\t",
+        R"({"symbol":"AAPL","price":"1","volume":"2","bid":"3","ask":"4"})",
+    };
+    for (const std::string& message : accepted) {
+        Tick tick;
+        if (!TickDecoder::decode(message.data(), message.size(), tick) || tick.ask != 4.0) {
+            std::printf("rejected: %s\n", message.c_str());
+            ok = false;
+        }
+    }
+
+    std::printf("tick decoder %s (%zu messages, %zu rejection cases)\n",
+                ok ? "ok" : "FAILED", corpus.size(), sizeof(rejected) / sizeof(rejected[0]));
+    return ok;
+}
+
+// Best of the repeats, in messages per second and MB/s
+template <typename Decode>
+void run(const char* label, const std::vector<std::string>& corpus, size_t bytes, int repeats,
+         Decode&& decode) {
+    double best = 1e300;
+    size_t decoded = 0;
+    for (int r = 0; r < repeats; ++r) {
+        decoded = 0;
+        auto start = Clock::now();
+        for (const std::string& message : corpus) decoded += decode(message) ? 1 : 0;
+        best = std::min(best, bench::millisecondsSince(start));
+    }
+    std::printf("%-14s %10.1f ms %12.0f msg/s %9.1f MB/s %8.0f ns/msg %7zu decoded\n", label, best,
+                corpus.size() * 1000.0 / best, bytes / 1000.0 / best, best * 1e6 / corpus.size(),
+                decoded);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Args args(argc, argv);
+    if (args.has("check")) return check() ? 0 : 1;
+
+    const int repeats = static_cast<int>(args.get("repeats", 5.0));
+    std::string path = args.get("corpus", std::string());
+    auto corpus = path.empty()
+        ? generateCorpus(static_cast<size_t>(args.get("messages", 200000.0)), nullptr)
+        : loadCorpus(path);
+    size_t bytes = 0;
+    for (const std::string& message : corpus) bytes += message.size();
+    std::printf("%zu messages, %.1f MB (%s)\n", corpus.size(), bytes / 1e6,
+                path.empty() ? "generated IEX-style" : path.c_str());
+
+    double checksum = 0.0;
+    run("TickDecoder", corpus, bytes, repeats, [&](const std::string& message) {
+        Tick tick;
+        if (!TickDecoder::decode(message.data(), message.size(), tick)) return false;
+        checksum += tick.price + tick.symbol.size();
+        return true;
+    });
+#ifdef QUARTZ_BENCH_NLOHMANN
+    // The fallback path in MarketDataFeed::processMessage
+    run("nlohmann::json", corpus, bytes, repeats, [&](const std::string& message) {
+        try {
+            auto j = nlohmann::json::parse(message.data(), message.data() + message.size());
+            checksum += j["price"].get<double>() + j["symbol"].get<std::string>().size();
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    });
+#else
+    std::printf("nlohmann::json not found; comparison skipped\n");
+#endif
+    bench::keep(checksum);
+    return 0;
+}
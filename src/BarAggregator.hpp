@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "QuoteTable.hpp"
+#include "StateVectorKernels.hpp"
+#include "TickCapture.hpp"
+
+namespace quantum_allocation {
+
+enum class BarField { Open, High, Low, Close, Volume, Vwap };
+constexpr size_t kBarFields = 6;
+
+// Completed bars, one fixed-capacity ring per symbol and one array per
+// field (symbol-major: field[symbol * capacity + slot]). Only the last
+// `capacity` bars of each symbol are kept.
+class BarSeries {
+public:
+    BarSeries(size_t num_symbols, size_t capacity)
+        : num_symbols_(num_symbols), capacity_(std::max<size_t>(1, capacity)),
+          counts_(num_symbols), end_ns_(num_symbols * capacity_) {
+        for (auto& field : fields_) {
+            field.resize(num_symbols * capacity_);
+        }
+    }
+
+    size_t numSymbols() const { return num_symbols_; }
+    size_t capacity() const { return capacity_; }
+
+    // Bars ever closed for the symbol, including ones overwritten since
+    size_t count(SymbolId symbol) const {
+        return counts_[symbol];
+    }
+
+    // ago = 0 is the most recent bar; the caller checks ago < min(count, capacity)
+    double value(BarField field, SymbolId symbol, size_t ago) const {
+        return fields_[static_cast<size_t>(field)][index(symbol, counts_[symbol] - 1 - ago)];
+    }
+
+    int64_t endNs(SymbolId symbol, size_t ago) const {
+        return end_ns_[index(symbol, counts_[symbol] - 1 - ago)];
+    }
+
+    void append(SymbolId symbol, const double (&values)[kBarFields], int64_t end_ns) {
+        size_t slot = index(symbol, counts_[symbol]);
+        for (size_t f = 0; f < kBarFields; ++f) {
+            fields_[f][slot] = values[f];
+        }
+        end_ns_[slot] = end_ns;
+        ++counts_[symbol];
+    }
+
+    // Last `bars` values of one field for every symbol, oldest first, as a
+    // row-major bars x numSymbols() matrix. Symbols with fewer bars are
+    // padded at the top with their oldest available value (0 if none).
+    void matrix(BarField field, size_t bars, kernels::AlignedVector<double>& out) const {
+        bars = std::min(bars, capacity_);
+        out.resize(bars * num_symbols_);
+        const auto& data = fields_[static_cast<size_t>(field)];
+        for (size_t s = 0; s < num_symbols_; ++s) {
+            size_t available = std::min(counts_[s], capacity_);
+            for (size_t row = 0; row < bars; ++row) {
+                size_t ago = bars - 1 - row;
+                if (available == 0) {
+                    out[row * num_symbols_ + s] = 0.0;
+                    continue;
+                }
+                ago = std::min(ago, available - 1);
+                out[row * num_symbols_ + s] = data[index(s, counts_[s] - 1 - ago)];
+            }
+        }
+    }
+
+private:
+    size_t index(SymbolId symbol, size_t sequence) const {
+        return symbol * capacity_ + sequence % capacity_;
+    }
+
+    size_t num_symbols_;
+    size_t capacity_;
+    std::vector<size_t> counts_;
+    kernels::AlignedVector<double> fields_[kBarFields];
+    std::vector<int64_t> end_ns_;
+};
+
+struct BarSettings {
+    int64_t interval_ns = 60'000'000'000;  // Time bar length
+    double volume_threshold = 0.0;         // Volume per volume bar (0 = off)
+    size_t capacity = 1024;                // Completed bars kept per symbol
+};
+
+// Builds OHLCV/VWAP bars per symbol as ticks arrive. Time bars close for
+// every symbol together on interval boundaries, so their rows line up
+// across symbols (a symbol without ticks repeats its last close with zero
+// volume). Volume bars, when enabled, close per symbol once the threshold
+// is traded. Bars being formed live in per-field arrays indexed by symbol.
+//
+// onTick/advanceTo are single-threaded. For live use start() a background
+// aggregation thread fed through one SPSC ring per producer; completed bars
+// are then read under a lock that is only taken when bars close.
+class BarAggregator {
+public:
+    static constexpr size_t kDefaultRingCapacity = 1 << 16;
+
+    BarAggregator(size_t num_symbols, const BarSettings& settings = BarSettings())
+        : settings_(settings), time_forming_(num_symbols), volume_forming_(num_symbols),
+          time_bars_(num_symbols, settings.capacity),
+          volume_bars_(settings.volume_threshold > 0.0 ? num_symbols : 0, settings.capacity) {
+        settings_.interval_ns = std::max<int64_t>(1, settings_.interval_ns);
+    }
+
+    ~BarAggregator() {
+        stop();
+    }
+
+    BarAggregator(const BarAggregator&) = delete;
+    BarAggregator& operator=(const BarAggregator&) = delete;
+
+    size_t numSymbols() const {
+        return time_bars_.numSymbols();
+    }
+
+    const BarSettings& settings() const {
+        return settings_;
+    }
+
+    void onTick(SymbolId symbol, double price, double volume, int64_t timestamp_ns) {
+        if (symbol >= numSymbols() || !(price > 0.0)) return;
+        if (timestamp_ns >= time_end_ns_) {
+            advanceTo(timestamp_ns);
+        }
+        time_forming_.add(symbol, price, volume);
+
+        if (settings_.volume_threshold > 0.0) {
+            volume_forming_.add(symbol, price, volume);
+            if (volume_forming_.volume[symbol] >= settings_.volume_threshold) {
+                double values[kBarFields];
+                volume_forming_.finish(symbol, values);
+                std::lock_guard<std::mutex> lock(mutex_);
+                volume_bars_.append(symbol, values, timestamp_ns);
+            }
+        }
+        ticks_.store(ticks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Closes every time bar that ends at or before timestamp_ns. A gap
+    // longer than the ring emits only as many empty bars as the ring holds.
+    void advanceTo(int64_t timestamp_ns) {
+        const int64_t interval = settings_.interval_ns;
+        if (time_end_ns_ == kUnstarted) {
+            time_end_ns_ = (timestamp_ns / interval + 1) * interval;
+            return;
+        }
+        if (timestamp_ns < time_end_ns_) return;
+
+        int64_t closes = (timestamp_ns - time_end_ns_) / interval + 1;
+        int64_t skip = std::max<int64_t>(0, closes - static_cast<int64_t>(time_bars_.capacity()));
+        time_end_ns_ += skip * interval;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int64_t c = skip; c < closes; ++c) {
+            double values[kBarFields];
+            for (size_t s = 0; s < numSymbols(); ++s) {
+                time_forming_.finish(static_cast<SymbolId>(s), values);
+                time_bars_.append(static_cast<SymbolId>(s), values, time_end_ns_);
+            }
+            time_end_ns_ += interval;
+        }
+        if (numSymbols() > 0) {
+            time_bar_count_.store(time_bars_.count(0), std::memory_order_release);
+        }
+    }
+
+    // Starts the aggregation thread with one ring per producer
+    void start(size_t num_producers, size_t ring_capacity = kDefaultRingCapacity) {
+        if (running_) return;
+        rings_.clear();
+        for (size_t i = 0; i < std::max<size_t>(1, num_producers); ++i) {
+            rings_.push_back(std::make_unique<SpscRing<TickRecord>>(ring_capacity));
+        }
+        stopping_.store(false, std::memory_order_relaxed);
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        if (!running_) return;
+        stopping_.store(true, std::memory_order_release);
+        thread_.join();
+        running_ = false;
+    }
+
+    // Called only from the producer thread that owns ring `producer`
+    void push(size_t producer, SymbolId symbol, double price, double volume, int64_t timestamp_ns) {
+        TickRecord record;
+        record.timestamp_ns = timestamp_ns;
+        record.symbol = symbol;
+        record.flags = 0;
+        record.quote = {price, volume, 0.0, 0.0};
+        if (!rings_[producer]->tryPush(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Asks the aggregation thread to close time bars up to timestamp_ns even
+    // if no tick arrives, e.g. from a wall-clock timer
+    void closeThrough(int64_t timestamp_ns) {
+        int64_t current = close_request_ns_.load(std::memory_order_relaxed);
+        while (current < timestamp_ns &&
+               !close_request_ns_.compare_exchange_weak(current, timestamp_ns)) {
+        }
+    }
+
+    // Time bars closed so far (the same for every symbol)
+    size_t timeBarCount() const {
+        return time_bar_count_.load(std::memory_order_acquire);
+    }
+
+    // The time bars closed after bar number `first`, at most max_bars of
+    // them (the newest), as a row-major matrix like timeBarMatrix. The count
+    // and the rows are read under one lock, so a bar closing meanwhile is
+    // neither returned twice nor skipped. Returns the time bars closed so
+    // far: pass it back as `first` next time.
+    size_t timeBarsSince(BarField field, size_t first, size_t max_bars,
+                         kernels::AlignedVector<double>& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t closed = numSymbols() > 0 ? time_bars_.count(0) : 0;
+        size_t fresh = closed > first ? std::min(closed - first, max_bars) : 0;
+        time_bars_.matrix(field, fresh, out);
+        return closed;
+    }
+
+    void timeBarMatrix(BarField field, size_t bars, kernels::AlignedVector<double>& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        time_bars_.matrix(field, bars, out);
+    }
+
+    void volumeBarMatrix(BarField field, size_t bars, kernels::AlignedVector<double>& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        volume_bars_.matrix(field, bars, out);
+    }
+
+    size_t volumeBarCount(SymbolId symbol) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return volume_bars_.numSymbols() ? volume_bars_.count(symbol) : 0;
+    }
+
+    uint64_t ticks() const {
+        return ticks_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int64_t kUnstarted = std::numeric_limits<int64_t>::min();
+    static constexpr size_t kBatch = 1024;
+
+    // State of the bars being built, one array per field
+    struct FormingBars {
+        explicit FormingBars(size_t n)
+            : open(n), high(n), low(n), close(n), volume(n), notional(n), ticks(n) {}
+
+        void add(SymbolId s, double price, double qty) {
+            if (ticks[s] == 0) {
+                open[s] = high[s] = low[s] = price;
+            } else {
+                high[s] = std::max(high[s], price);
+                low[s] = std::min(low[s], price);
+            }
+            close[s] = price;
+            volume[s] += qty;
+            notional[s] += price * qty;
+            ++ticks[s];
+        }
+
+        // Emits the bar and starts the next one from its close
+        void finish(SymbolId s, double (&values)[kBarFields]) {
+            if (ticks[s] == 0) {
+                open[s] = high[s] = low[s] = close[s];
+            }
+            values[static_cast<size_t>(BarField::Open)] = open[s];
+            values[static_cast<size_t>(BarField::High)] = high[s];
+            values[static_cast<size_t>(BarField::Low)] = low[s];
+            values[static_cast<size_t>(BarField::Close)] = close[s];
+            values[static_cast<size_t>(BarField::Volume)] = volume[s];
+            values[static_cast<size_t>(BarField::Vwap)] =
+                volume[s] > 0.0 ? notional[s] / volume[s] : close[s];
+            volume[s] = 0.0;
+            notional[s] = 0.0;
+            ticks[s] = 0;
+        }
+
+        kernels::AlignedVector<double> open, high, low, close, volume, notional;
+        std::vector<uint32_t> ticks;
+    };
+
+    void run() {
+        std::vector<TickRecord> batch(kBatch);
+        for (;;) {
+            bool stopping = stopping_.load(std::memory_order_acquire);
+            size_t drained = 0;
+            for (auto& ring : rings_) {
+                size_t count;
+                while ((count = ring->popBatch(batch.data(), kBatch)) > 0) {
+                    for (size_t i = 0; i < count; ++i) {
+                        const TickRecord& r = batch[i];
+                        onTick(r.symbol, r.quote.price, r.quote.volume, r.timestamp_ns);
+                    }
+                    drained += count;
+                }
+            }
+            int64_t requested = close_request_ns_.load(std::memory_order_relaxed);
+            if (requested != kUnstarted && time_end_ns_ != kUnstarted) {
+                advanceTo(requested);
+            }
+            if (stopping) break;
+            if (drained == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+    BarSettings settings_;
+    FormingBars time_forming_;
+    FormingBars volume_forming_;
+    BarSeries time_bars_;
+    BarSeries volume_bars_;
+    int64_t time_end_ns_ = kUnstarted;
+    std::atomic<uint64_t> ticks_{0};
+
+    mutable std::mutex mutex_;
+    std::atomic<size_t> time_bar_count_{0};
+    std::atomic<int64_t> close_request_ns_{kUnstarted};
+
+    std::vector<std::unique_ptr<SpscRing<TickRecord>>> rings_;
+    std::thread thread_;
+    bool running_ = false;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace quantum_allocation
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace quantum_allocation {
+
+// Number encoders for FIX field values. They write into caller buffers,
+// never allocate and avoid the locale and format parsing of printf, which
+// dominates the cost of building an order the generic way.
+namespace fix_format {
+
+constexpr size_t kMaxNumberLength = 32;
+
+namespace detail {
+
+constexpr char kDigitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+constexpr uint64_t kPow10[] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+                               10000000ull, 100000000ull};
+
+} // namespace detail
+
+constexpr int kMaxDecimals = 8;
+
+// Decimal digits of value; returns the length (at most 20)
+inline size_t formatUnsigned(char* out, uint64_t value) {
+    char buffer[20];
+    char* p = buffer + sizeof(buffer);
+    while (value >= 100) {
+        const char* pair = detail::kDigitPairs + (value % 100) * 2;
+        value /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (value >= 10) {
+        const char* pair = detail::kDigitPairs + value * 2;
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    size_t length = buffer + sizeof(buffer) - p;
+    std::memcpy(out, p, length);
+    return length;
+}
+
+// value rounded to `decimals` places, trailing zeros and a bare point
+// dropped ("189.31", "100"). Values too large for the integer path go
+// through snprintf.
+inline size_t formatFixed(char* out, double value, int decimals) {
+    decimals = decimals < 0 ? 0 : (decimals > kMaxDecimals ? kMaxDecimals : decimals);
+    const uint64_t scale = detail::kPow10[decimals];
+    if (!(std::abs(value) * scale < 9.0e18)) {
+        int written = std::snprintf(out, kMaxNumberLength, "%.*f", decimals, value);
+        if (written <= 0) return 0;
+        return std::min(static_cast<size_t>(written), kMaxNumberLength - 1);
+    }
+
+    size_t length = 0;
+    uint64_t scaled = static_cast<uint64_t>(std::llround(std::abs(value) * scale));
+    if (value < 0.0 && scaled != 0) out[length++] = '-';
+    uint64_t whole = scaled / scale;
+    uint64_t fraction = scaled % scale;
+    length += formatUnsigned(out + length, whole);
+    if (fraction == 0) return length;
+
+    int places = decimals;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        --places;
+    }
+    out[length++] = '.';
+    char digits[20];
+    size_t count = formatUnsigned(digits, fraction);
+    // Leading zeros of the fraction, e.g. 0.05 -> "05"
+    for (size_t pad = count; pad < static_cast<size_t>(places); ++pad) {
+        out[length++] = '0';
+    }
+    std::memcpy(out + length, digits, count);
+    return length + count;
+}
+
+} // namespace fix_format
+
+} // namespace quantum_allocation
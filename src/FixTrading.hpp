@@ -6,8 +6,17 @@
 #include <quickfix/Values.h>
 #include <quickfix/SocketInitiator.h>
 #include <quickfix/Session.h>
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
+#include "FixFormat.hpp"
+#include "OrderManager.hpp"
+#include "PositionBook.hpp"
+#include "QuoteTable.hpp"
+#include "RiskGate.hpp"
 
 namespace quantum_allocation {
 
@@ -30,9 +39,49 @@ public:
     void stop() {
         initiator_->stop();
     }
+
+    // Resolves FIX symbols to dense IDs for the per-symbol order templates
+    // and the risk gate
+    void attachSymbols(const SymbolTable& symbols) {
+        symbols_ = &symbols;
+        templates_.clear();
+        templates_.resize(2 * symbols.capacity());
+    }
+
+    // Every order is checked against the gate before it is sent and every
+    // execution report is fed back into it; needs attachSymbols
+    void attachRiskGate(PreTradeRiskGate& gate) {
+        risk_gate_ = &gate;
+    }
+
+    // Execution reports keep the manager's view of working orders current;
+    // orders sent through submit() are tracked there
+    void attachOrderManager(OrderManager& manager) {
+        order_manager_ = &manager;
+    }
+
+    // Fills are booked here on the FIX thread; the strategy reads positions
+    // and P&L back without locks. Needs attachSymbols
+    void attachPositionBook(PositionBook& book) {
+        position_book_ = &book;
+    }
+
+    // Builds both side templates for each symbol ahead of the first order
+    void prepareOrderTemplates(const std::vector<SymbolId>& ids) {
+        for (SymbolId id : ids) {
+            orderTemplate(id, FIX::Side_BUY);
+            orderTemplate(id, FIX::Side_SELL);
+        }
+    }
     
-    // Send a new order
-    void sendOrder(const std::string& symbol, char side, double quantity, double price) {
+    // Send a new order; anything but Accepted means it was not sent
+    RiskCheck sendOrder(const std::string& symbol, char side, double quantity, double price) {
+        SymbolId id = symbols_ ? symbols_->find(symbol) : kInvalidSymbol;
+        if (id != kInvalidSymbol) {
+            return sendOrder(id, side, quantity, price);
+        }
+        if (risk_gate_) return RiskCheck::Invalid;
+
         FIX44::NewOrderSingle message;
         message.setField(FIX::ClOrdID(getNextOrderID()));
         message.setField(FIX::Symbol(symbol));
@@ -42,14 +91,110 @@ public:
         message.setField(FIX::OrdType(FIX::OrdType_LIMIT));
         message.setField(FIX::TimeInForce(FIX::TimeInForce_DAY));
         
-        FIX::Session::sendToTarget(message);
+        sendMessage(message);
+        return RiskCheck::Accepted;
+    }
+
+    // Order path for interned symbols: a prebuilt NewOrderSingle per
+    // symbol and side with only ClOrdID, OrderQty and Price patched in,
+    // numbers encoded without printf, sent straight to the logged-on
+    // session. Called from one thread (the templates are reused in place).
+    RiskCheck sendOrder(SymbolId id, char side, double quantity, double price) {
+        if (risk_gate_) {
+            RiskCheck check = risk_gate_->check(id, side, quantity, price);
+            if (check != RiskCheck::Accepted) return check;
+        }
+
+        FIX44::NewOrderSingle& message = orderTemplate(id, side).order;
+        char buffer[fix_format::kMaxNumberLength];
+        message.setField(FIX::FIELD::ClOrdID, std::string(buffer, formatOrderID(buffer)));
+        message.setField(FIX::FIELD::OrderQty,
+                         std::string(buffer, fix_format::formatFixed(buffer, quantity, kQtyDecimals)));
+        message.setField(FIX::FIELD::Price,
+                         std::string(buffer, fix_format::formatFixed(buffer, price, kPriceDecimals)));
+
+        try {
+            sendMessage(message);
+        } catch (const FIX::SessionNotFound&) {
+            if (risk_gate_) risk_gate_->release(id, side, quantity, price);
+            throw;
+        }
+        return RiskCheck::Accepted;
+    }
+
+    // Sends one rebalance's worth of order manager actions in a single pass
+    // over the cached session. Growth in open quantity is checked against
+    // the risk gate first; a rejected action keeps its result and is not
+    // sent. Returns the number of messages sent.
+    size_t submit(std::vector<OrderAction>& batch) {
+        size_t sent = 0;
+        char buffer[fix_format::kMaxNumberLength];
+        for (OrderAction& action : batch) {
+            if (risk_gate_ && action.leaves_delta > 0.0) {
+                action.result = risk_gate_->check(action.symbol, action.side, action.leaves_delta,
+                                                  action.price);
+                if (action.result != RiskCheck::Accepted) continue;
+            }
+
+            action.order_id = ++orderID_;
+            // Registered before sending so racing reports find it; an amend or
+            // cancel of an order that finished since net() is dropped
+            if (order_manager_ && !order_manager_->onSending(action)) {
+                releaseReserved(action);
+                continue;
+            }
+
+            OrderTemplates& templates = orderTemplate(action.symbol, action.side);
+            FIX::Message* message = nullptr;
+            switch (action.type) {
+            case OrderAction::Type::New:
+                message = &templates.order;
+                break;
+            case OrderAction::Type::Replace:
+                message = &templates.replace;
+                message->setField(FIX::FIELD::OrigClOrdID,
+                                  std::string(buffer, formatOrderID(buffer, action.orig_order_id)));
+                break;
+            case OrderAction::Type::Cancel:
+                message = &templates.cancel;
+                message->setField(FIX::FIELD::OrigClOrdID,
+                                  std::string(buffer, formatOrderID(buffer, action.orig_order_id)));
+                break;
+            }
+            message->setField(FIX::FIELD::ClOrdID,
+                              std::string(buffer, formatOrderID(buffer, action.order_id)));
+            message->setField(FIX::FIELD::OrderQty,
+                              std::string(buffer, fix_format::formatFixed(buffer, action.quantity,
+                                                                          kQtyDecimals)));
+            if (action.type != OrderAction::Type::Cancel) {
+                message->setField(FIX::FIELD::Price,
+                                  std::string(buffer, fix_format::formatFixed(buffer, action.price,
+                                                                              kPriceDecimals)));
+            }
+
+            try {
+                sendMessage(*message);
+            } catch (const FIX::SessionNotFound&) {
+                if (order_manager_) order_manager_->onSendFailed(action);
+                releaseReserved(action);
+                throw;
+            }
+            ++sent;
+        }
+        return sent;
     }
     
 private:
     // FIX::Application interface implementation
     void onCreate(const FIX::SessionID&) override {}
-    void onLogon(const FIX::SessionID&) override {}
-    void onLogout(const FIX::SessionID&) override {}
+    // The order path sends through this pointer instead of looking the
+    // session up by comp IDs on every order
+    void onLogon(const FIX::SessionID& sessionID) override {
+        session_.store(FIX::Session::lookupSession(sessionID), std::memory_order_release);
+    }
+    void onLogout(const FIX::SessionID&) override {
+        session_.store(nullptr, std::memory_order_release);
+    }
     void toAdmin(FIX::Message&, const FIX::SessionID&) override {}
     void toApp(FIX::Message&, const FIX::SessionID&) throw(FIX::DoNotSend) override {}
     void fromAdmin(const FIX::Message&, const FIX::SessionID&) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon) override {}
@@ -63,7 +208,8 @@ private:
         FIX::ExecType execType;
         message.getField(execType);
         
-        if (execType == FIX::ExecType_FILL) {
+        if (execType == FIX::ExecType_FILL || execType == FIX::ExecType_PARTIAL_FILL ||
+            execType == FIX::ExecType_TRADE) {
             FIX::Symbol symbol;
             FIX::Side side;
             FIX::LastQty lastQty;
@@ -76,23 +222,144 @@ private:
             
             // Handle the fill
             handleFill(symbol, side, lastQty, lastPx);
+            if (order_manager_) order_manager_->onFill(clOrdID(message), lastQty);
+        } else if (execType == FIX::ExecType_CANCELED || execType == FIX::ExecType_EXPIRED ||
+                   execType == FIX::ExecType_REJECTED) {
+            handleDone(message);
+            if (order_manager_) order_manager_->onDone(clOrdID(message));
+        } else if (execType == FIX::ExecType_NEW) {
+            if (order_manager_) order_manager_->onAck(clOrdID(message));
+        } else if (execType == FIX::ExecType_REPLACED) {
+            if (!order_manager_) return;
+            FIX::OrigClOrdID origClOrdID;
+            message.getField(origClOrdID);
+            release(order_manager_->onReplaced(parseOrderID(origClOrdID), clOrdID(message)));
+        }
+    }
+
+    // A refused replace or cancel; the order keeps working as before
+    void onMessage(const FIX44::OrderCancelReject& message, const FIX::SessionID&) {
+        if (order_manager_) release(order_manager_->onCancelReject(clOrdID(message)));
+    }
+
+    // Gives back what the gate reserved for an action that was not sent
+    void releaseReserved(const OrderAction& action) {
+        if (risk_gate_ && action.leaves_delta > 0.0) {
+            risk_gate_->release(action.symbol, action.side, action.leaves_delta, action.price);
+        }
+    }
+
+    void release(const ReleasedQuantity& released) {
+        if (risk_gate_ && released.quantity > 0.0) {
+            risk_gate_->release(released.symbol, released.side, released.quantity, released.price);
         }
     }
     
     void handleFill(const FIX::Symbol& symbol, const FIX::Side& side, 
                    const FIX::LastQty& qty, const FIX::LastPx& price) {
-        // Update portfolio with execution details
-        // Implement fill handling logic here
+        if (!symbols_) return;
+        SymbolId id = symbols_->find(symbol.getValue());
+        if (position_book_) position_book_->onFill(id, side, qty, price);
+        if (risk_gate_) risk_gate_->onFill(id, side, qty, price);
+    }
+
+    // The unfilled remainder of a dead order no longer counts against limits
+    void handleDone(const FIX44::ExecutionReport& message) {
+        if (!risk_gate_ || !symbols_) return;
+        FIX::Symbol symbol;
+        FIX::Side side;
+        FIX::OrderQty orderQty;
+        FIX::CumQty cumQty;
+        FIX::Price price;
+        message.getField(symbol);
+        message.getField(side);
+        message.getField(orderQty);
+        message.getField(cumQty);
+        if (!message.getFieldIfSet(price)) return;
+        risk_gate_->release(symbols_->find(symbol.getValue()), side, orderQty - cumQty, price);
     }
     
     std::string getNextOrderID() {
-        return "ORD" + std::to_string(++orderID_);
+        char buffer[fix_format::kMaxNumberLength];
+        return std::string(buffer, formatOrderID(buffer));
+    }
+
+    // "ORD" followed by the next order number
+    size_t formatOrderID(char* out) {
+        return formatOrderID(out, ++orderID_);
+    }
+
+    static size_t formatOrderID(char* out, uint64_t number) {
+        std::memcpy(out, "ORD", 3);
+        return 3 + fix_format::formatUnsigned(out + 3, number);
+    }
+
+    // Order number of an "ORD<n>" ClOrdID; 0 for IDs this process did not issue
+    static uint64_t parseOrderID(const std::string& id) {
+        uint64_t number = 0;
+        if (id.size() <= 3 || id.compare(0, 3, "ORD") != 0) return 0;
+        auto result = std::from_chars(id.data() + 3, id.data() + id.size(), number);
+        return result.ec == std::errc() && result.ptr == id.data() + id.size() ? number : 0;
     }
+
+    static uint64_t clOrdID(const FIX::Message& message) {
+        FIX::ClOrdID id;
+        return message.getFieldIfSet(id) ? parseOrderID(id) : 0;
+    }
+
+    // Prebuilt messages for one symbol and side; only IDs, quantity and
+    // price change between sends
+    struct OrderTemplates {
+        FIX44::NewOrderSingle order;
+        FIX44::OrderCancelReplaceRequest replace;
+        FIX44::OrderCancelRequest cancel;
+    };
+
+    OrderTemplates& orderTemplate(SymbolId id, char side) {
+        auto& slot = templates_[2 * id + (side == FIX::Side_BUY ? 0 : 1)];
+        if (!slot) {
+            slot = std::make_unique<OrderTemplates>();
+            FIX::Symbol symbol(symbols_->name(id));
+            FIX::Side fix_side(side);
+            slot->order.setField(symbol);
+            slot->order.setField(fix_side);
+            slot->order.setField(FIX::OrdType(FIX::OrdType_LIMIT));
+            slot->order.setField(FIX::TimeInForce(FIX::TimeInForce_DAY));
+            slot->replace.setField(symbol);
+            slot->replace.setField(fix_side);
+            slot->replace.setField(FIX::OrdType(FIX::OrdType_LIMIT));
+            slot->replace.setField(FIX::TimeInForce(FIX::TimeInForce_DAY));
+            slot->cancel.setField(symbol);
+            slot->cancel.setField(fix_side);
+        }
+        return *slot;
+    }
+
+    // Every order, replace and cancel carries the time it was sent; the
+    // templates are restamped here rather than keeping a stale TransactTime
+    void sendMessage(FIX::Message& message) {
+        message.setField(FIX::TransactTime());
+        FIX::Session* session = session_.load(std::memory_order_acquire);
+        if (session) {
+            session->send(message);
+        } else {
+            FIX::Session::sendToTarget(message);
+        }
+    }
+
+    static constexpr int kQtyDecimals = 4;
+    static constexpr int kPriceDecimals = 6;
     
     FIX::SessionSettings settings_;
     FIX::FileStoreFactory storeFactory_;
     std::unique_ptr<FIX::SocketInitiator> initiator_;
-    std::atomic<int> orderID_{0};
+    std::atomic<uint64_t> orderID_{0};
+    std::atomic<FIX::Session*> session_{nullptr};
+    std::vector<std::unique_ptr<OrderTemplates>> templates_;  // [2 * id + side]
+    PreTradeRiskGate* risk_gate_ = nullptr;
+    OrderManager* order_manager_ = nullptr;
+    PositionBook* position_book_ = nullptr;
+    const SymbolTable* symbols_ = nullptr;
 };
 
 } // namespace quantum_allocation
@@ -31,6 +31,26 @@ public:
         portfolio_ = portfolio;
     }
 
+    // Calls the strategy's onOrderRejected(symbol, side, quantity, price,
+    // reason) if it defines one
+    void onOrderRejected(const std::string& symbol, char side, double quantity, double price,
+                         const char* reason) {
+        lua_getglobal(L, "onOrderRejected");
+        if (!lua_isfunction(L, -1)) {
+            lua_pop(L, 1);
+            return;
+        }
+        lua_pushstring(L, symbol.c_str());
+        lua_pushlstring(L, &side, 1);
+        lua_pushnumber(L, quantity);
+        lua_pushnumber(L, price);
+        lua_pushstring(L, reason);
+        if (lua_pcall(L, 5, 0, 0) != 0) {
+            std::cerr << "Lua error: " << lua_tostring(L, -1) << std::endl;
+            lua_pop(L, 1);
+        }
+    }
+
 private:
     void registerFunctions() {
         // Register C++ functions to be called from Lua
@@ -78,6 +98,11 @@ function setCustomConstraints()
     addConstraint("GOOGL", 0.0, 0.25) -- Max 25% in GOOGL
 end
 
+-- Pre-trade risk gate rejections (reason is e.g. "max_position")
+function onOrderRejected(symbol, side, quantity, price, reason)
+    print("Order rejected: " .. symbol .. " " .. reason)
+end
+
 -- Execute strategy
 adjustRiskParameters()
 setCustomConstraints()
@@ -4,13 +4,33 @@
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/strand.hpp>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
 #include <queue>
 #include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "BarAggregator.hpp"
+#include "QuoteTable.hpp"
+#include "StateVectorKernels.hpp"
+#include "ThreadPool.hpp"
+#include "TickCapture.hpp"
+#include "TickDecoder.hpp"
 
 namespace quantum_allocation {
 
 using json = nlohmann::json;
 
+// Market data ingest over one or more WebSocket connections to the same
+// endpoint. Each connection runs on its own io_context thread, so a slow
+// handler only stalls the symbols on that connection. All connections write
+// into one shared quote table; each symbol is owned by exactly one connection,
+// which keeps every quote slot single-writer.
 class MarketDataFeed {
 public:
     struct MarketData {
@@ -22,72 +42,534 @@ public:
         std::chrono::system_clock::time_point timestamp;
     };
 
-    MarketDataFeed(boost::asio::io_context& ioc)
-        : ioc_(ioc), ws_(std::make_unique<boost::beast::websocket::stream<boost::beast::tcp_stream>>(ioc)) {
+    using Quote = QuoteTable::Quote;
+
+    // Per-connection ingest counters. pending_bytes is what was still queued
+    // in the socket after the last frame was handled; if it keeps growing
+    // the connection's thread is falling behind its share of the feed.
+    struct ConnectionStats {
+        size_t symbols = 0;
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+        uint64_t fallback_parses = 0;
+        uint64_t reconnects = 0;
+        size_t pending_bytes = 0;
+        size_t max_pending_bytes = 0;
+        double max_handler_us = 0.0;
+        bool connected = false;
+    };
+
+    static constexpr size_t kDefaultSymbolCapacity = 1024;
+
+    // Size the table for every symbol that may ever be subscribed: a full
+    // table rejects further subscriptions
+    explicit MarketDataFeed(size_t symbol_capacity = kDefaultSymbolCapacity)
+        : symbols_(symbol_capacity), quotes_(symbol_capacity) {
+    }
+
+    ~MarketDataFeed() {
+        stop();
     }
 
-    void connect(const std::string& host, const std::string& port) {
-        boost::asio::ip::tcp::resolver resolver(ioc_);
-        auto const results = resolver.resolve(host, port);
+    MarketDataFeed(const MarketDataFeed&) = delete;
+    MarketDataFeed& operator=(const MarketDataFeed&) = delete;
 
-        boost::beast::get_lowest_layer(*ws_).connect(results);
-        ws_->handshake(host, "/ws");
+    // Opens num_connections sockets and starts one reader thread per socket,
+    // pinned to core first_core + i when pin_threads is set (wrapping at the
+    // hardware thread count). Pass the number of pinned ThreadPool workers as
+    // first_core to keep readers off their cores. Throws if any initial
+    // connection fails; after that, dropped connections reconnect on their own.
+    void connect(const std::string& host, const std::string& port,
+                 size_t num_connections = 1, bool pin_threads = false, size_t first_core = 0) {
+        stop();
+        host_ = host;
+        port_ = port;
+        for (size_t i = 0; i < std::max<size_t>(1, num_connections); ++i) {
+            connections_.push_back(std::make_unique<Connection>(*this, i));
+            connections_.back()->open();
+        }
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        for (auto& connection : connections_) {
+            connection->start(pin_threads, (first_core + connection->index()) % cores);
+        }
+    }
 
-        asyncRead();
+    void stop() {
+        for (auto& connection : connections_) {
+            connection->stop();
+        }
+        connections_.clear();
+        // Readers are joined, so no producer can still hold the recorder
+        recorder_.store(nullptr, std::memory_order_relaxed);
+        capture_.reset();
+        if (BarAggregator* bars = bars_.exchange(nullptr)) {
+            bars->stop();
+        }
     }
 
-    void subscribe(const std::string& symbol) {
-        json subscription = {
-            {"type", "subscribe"},
-            {"symbol", symbol}
-        };
-        ws_->write(boost::asio::buffer(subscription.dump()));
+    // Streams every published tick into the aggregator, starting its
+    // aggregation thread with one ring per connection (one for replay).
+    // The aggregator must outlive the feed or its stop().
+    void attachBars(BarAggregator& bars) {
+        bars.start(std::max<size_t>(1, connections_.size()));
+        bars_.store(&bars, std::memory_order_release);
+    }
+
+    // Starts recording every decoded tick to a binary capture file. Must
+    // follow connect(): each connection gets its own ring. Recording stops
+    // with stop().
+    void startCapture(const std::string& path) {
+        if (connections_.empty()) {
+            throw std::logic_error("MarketDataFeed::startCapture called before connect");
+        }
+        if (capture_) return;
+        capture_ = std::make_unique<TickRecorder>(path, symbols_, connections_.size());
+        recorder_.store(capture_.get(), std::memory_order_release);
+    }
+
+    const TickRecorder* capture() const {
+        return capture_.get();
+    }
+
+    // Feeds a capture file into the quote table from the calling thread,
+    // which becomes the only writer, so the feed must not be connected.
+    // speed 1 replays at the recorded pace, 10 ten times faster, and 0 as
+    // fast as possible. Returns the number of ticks replayed.
+    size_t replay(const std::string& path, double speed = 0.0) {
+        if (!connections_.empty()) {
+            throw std::logic_error("MarketDataFeed::replay called while connected");
+        }
+        TickReader reader(path);
+        std::vector<SymbolId> ids;
+        size_t ticks = 0;
+        int64_t first_ns = 0;
+        auto wall_start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < reader.size(); ++i) {
+            const TickRecord& record = reader.records()[i];
+            if (record.flags & TickRecord::kSymbolDefinition) {
+                if (record.symbol >= ids.size()) ids.resize(record.symbol + 1, kInvalidSymbol);
+                ids[record.symbol] = internOrReject(TickReader::symbolName(record));
+                continue;
+            }
+            if (record.symbol >= ids.size() || ids[record.symbol] == kInvalidSymbol) continue;
+
+            if (ticks == 0) first_ns = record.timestamp_ns;
+            if (speed > 0.0) {
+                auto offset = std::chrono::nanoseconds(
+                    static_cast<int64_t>((record.timestamp_ns - first_ns) / speed));
+                std::this_thread::sleep_until(wall_start + offset);
+            }
+            quotes_.update(ids[record.symbol], record.quote.price, record.quote.volume,
+                           record.quote.bid, record.quote.ask,
+                           std::chrono::system_clock::time_point(
+                               std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                   std::chrono::nanoseconds(record.timestamp_ns))));
+            if (BarAggregator* bars = bars_.load(std::memory_order_acquire)) {
+                bars->push(0, ids[record.symbol], record.quote.price, record.quote.volume,
+                           record.timestamp_ns);
+            }
+            ++ticks;
+        }
+        return ticks;
+    }
+
+    // Interns the symbol before subscribing so its first tick already has a
+    // slot. Symbols are dealt to connections by ID, round-robin.
+    SymbolId subscribe(const std::string& symbol) {
+        return subscribe(std::vector<std::string>{symbol}).front();
+    }
+
+    // Interns every symbol, then hands each connection its share in one
+    // batch; the connection sends them as multi-symbol frames from its own
+    // thread, so the caller never blocks on the socket. Symbols that no
+    // longer fit in the symbol table are logged and get kInvalidSymbol.
+    std::vector<SymbolId> subscribe(const std::vector<std::string>& symbols) {
+        if (connections_.empty()) {
+            throw std::logic_error("MarketDataFeed::subscribe called before connect");
+        }
+        markColdStart();
+
+        std::vector<SymbolId> ids;
+        std::vector<std::vector<SymbolId>> batches(connections_.size());
+        ids.reserve(symbols.size());
+        for (const auto& symbol : symbols) {
+            size_t known = symbols_.size();
+            SymbolId id = internOrReject(symbol);
+            if (id != kInvalidSymbol && id >= known) {
+                awaiting_first_tick_.fetch_add(1, std::memory_order_relaxed);
+                batches[id % connections_.size()].push_back(id);
+            }
+            ids.push_back(id);
+        }
+        for (size_t i = 0; i < batches.size(); ++i) {
+            if (!batches[i].empty()) connections_[i]->subscribe(std::move(batches[i]));
+        }
+        return ids;
+    }
+
+    // Time from the first subscribe call until every subscribed symbol had
+    // its first tick; negative until then
+    double coldStartMs() const {
+        return cold_start_ms_.load(std::memory_order_acquire);
+    }
+
+    SymbolId symbolId(const std::string& symbol) const {
+        return symbols_.find(symbol);
+    }
+
+    const SymbolTable& symbols() const {
+        return symbols_;
+    }
+
+    // Lock-free snapshot of the latest quote; version 0 means no tick yet
+    Quote getLatestQuote(SymbolId id) const {
+        return quotes_.read(id);
+    }
+
+    uint64_t quoteVersion(SymbolId id) const {
+        return quotes_.version(id);
+    }
+
+    MarketData getLatestData(const std::string& symbol) const {
+        MarketData data{symbol, 0.0, 0.0, 0.0, 0.0, {}};
+        SymbolId id = symbols_.find(symbol);
+        if (id != kInvalidSymbol) {
+            Quote quote = quotes_.read(id);
+            data.price = quote.price;
+            data.volume = quote.volume;
+            data.bid = quote.bid;
+            data.ask = quote.ask;
+            data.timestamp = quote.timestamp;
+        }
+        return data;
     }
 
-    MarketData getLatestData(const std::string& symbol) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return latest_data_[symbol];
+    std::vector<ConnectionStats> connectionStats() const {
+        std::vector<ConnectionStats> stats;
+        for (const auto& connection : connections_) {
+            stats.push_back(connection->stats());
+        }
+        return stats;
     }
 
 private:
-    void asyncRead() {
-        ws_->async_read(
-            buffer_,
-            [this](boost::system::error_code ec, std::size_t bytes_transferred) {
-                if (!ec) {
-                    processMessage(boost::beast::buffers_to_string(buffer_.data()));
+    using WebSocket = boost::beast::websocket::stream<boost::beast::tcp_stream>;
+
+    class Connection {
+    public:
+        Connection(MarketDataFeed& feed, size_t index)
+            : feed_(feed), index_(index),
+              work_(boost::asio::make_work_guard(ioc_)), timer_(ioc_) {
+        }
+
+        ~Connection() {
+            stop();
+        }
+
+        // Blocking connect and handshake; runs on the caller for the first
+        // attempt and on this connection's thread for reconnects
+        void open() {
+            ws_ = std::make_unique<WebSocket>(ioc_);
+            boost::asio::ip::tcp::resolver resolver(ioc_);
+            auto const results = resolver.resolve(feed_.host_, feed_.port_);
+
+            boost::beast::get_lowest_layer(*ws_).connect(results);
+            ws_->handshake(feed_.host_, "/ws");
+            connected_.store(true, std::memory_order_relaxed);
+        }
+
+        void start(bool pin_thread, size_t core) {
+            boost::asio::post(ioc_, [this] { asyncRead(); });
+            thread_ = std::thread([this] {
+                try {
+                    ioc_.run();
+                } catch (const std::exception& e) {
+                    std::cerr << "Market data connection " << index_ << " error: " << e.what() << std::endl;
+                }
+            });
+            if (pin_thread) ThreadPool::pin(thread_, core);
+        }
+
+        void stop() {
+            work_.reset();
+            ioc_.stop();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        // Symbol lists live on the connection's thread so a reconnect can
+        // resubscribe without locking
+        void subscribe(std::vector<SymbolId> ids) {
+            boost::asio::post(ioc_, [this, ids = std::move(ids)] {
+                symbols_.insert(symbols_.end(), ids.begin(), ids.end());
+                num_symbols_.store(symbols_.size(), std::memory_order_relaxed);
+                if (!connected_.load(std::memory_order_relaxed)) return;
+                pending_subscribe_.insert(pending_subscribe_.end(), ids.begin(), ids.end());
+                writeNext();
+            });
+        }
+
+        size_t index() const {
+            return index_;
+        }
+
+        bool owns(SymbolId id) const {
+            return id % feed_.connections_.size() == index_;
+        }
+
+        ConnectionStats stats() const {
+            ConnectionStats stats;
+            stats.symbols = num_symbols_.load(std::memory_order_relaxed);
+            stats.messages = messages_.load(std::memory_order_relaxed);
+            stats.bytes = bytes_.load(std::memory_order_relaxed);
+            stats.fallback_parses = fallback_parses_.load(std::memory_order_relaxed);
+            stats.reconnects = reconnects_.load(std::memory_order_relaxed);
+            stats.pending_bytes = pending_bytes_.load(std::memory_order_relaxed);
+            stats.max_pending_bytes = max_pending_bytes_.load(std::memory_order_relaxed);
+            stats.max_handler_us = max_handler_us_.load(std::memory_order_relaxed);
+            stats.connected = connected_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        static constexpr std::chrono::milliseconds kMinBackoff{100};
+        static constexpr std::chrono::milliseconds kMaxBackoff{5000};
+
+        static constexpr size_t kSymbolsPerFrame = 256;
+
+        // Outbound writes run on this connection's single io_context thread,
+        // which serializes them like a strand. Subscriptions that pile up
+        // while a write is in flight are coalesced into as few frames as the
+        // per-frame limit allows.
+        void writeNext() {
+            if (writing_) return;
+            if (outbox_.empty()) {
+                for (size_t i = 0; i < pending_subscribe_.size(); i += kSymbolsPerFrame) {
+                    size_t end = std::min(pending_subscribe_.size(), i + kSymbolsPerFrame);
+                    outbox_.push_back(subscribeFrame(i, end));
+                }
+                pending_subscribe_.clear();
+            }
+            if (outbox_.empty()) return;
+
+            writing_ = true;
+            ws_->async_write(
+                boost::asio::buffer(outbox_.front()),
+                [this](boost::system::error_code ec, std::size_t) {
+                    writing_ = false;
+                    // A failed write surfaces as a read error, which reconnects
+                    if (ec) return;
+                    outbox_.pop_front();
+                    writeNext();
+                });
+        }
+
+        std::string subscribeFrame(size_t begin, size_t end) const {
+            if (end - begin == 1) {
+                json subscription = {
+                    {"type", "subscribe"},
+                    {"symbol", feed_.symbols_.name(pending_subscribe_[begin])}
+                };
+                return subscription.dump();
+            }
+            json names = json::array();
+            for (size_t i = begin; i < end; ++i) {
+                names.push_back(feed_.symbols_.name(pending_subscribe_[i]));
+            }
+            json subscription = {
+                {"type", "subscribe"},
+                {"symbols", std::move(names)}
+            };
+            return subscription.dump();
+        }
+
+        void asyncRead() {
+            ws_->async_read(
+                buffer_,
+                [this](boost::system::error_code ec, std::size_t bytes_transferred) {
+                    if (ec) {
+                        onError(ec);
+                        return;
+                    }
+                    auto start = std::chrono::steady_clock::now();
+
+                    // flat_buffer is contiguous, so decode straight from its bytes
+                    auto bytes = buffer_.cdata();
+                    if (!feed_.processMessage(static_cast<const char*>(bytes.data()), bytes.size(), *this)) {
+                        fallback_parses_.fetch_add(1, std::memory_order_relaxed);
+                    }
                     buffer_.consume(buffer_.size());
+
+                    recordMessage(bytes_transferred, std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - start).count());
                     asyncRead();
+                });
+        }
+
+        // Counters have a single writer, so plain load/store is enough
+        void recordMessage(size_t bytes, double handler_us) {
+            messages_.store(messages_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            bytes_.store(bytes_.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+            if (handler_us > max_handler_us_.load(std::memory_order_relaxed)) {
+                max_handler_us_.store(handler_us, std::memory_order_relaxed);
+            }
+
+            boost::system::error_code ec;
+            size_t pending = boost::beast::get_lowest_layer(*ws_).socket().available(ec);
+            if (ec) pending = 0;
+            pending_bytes_.store(pending, std::memory_order_relaxed);
+            if (pending > max_pending_bytes_.load(std::memory_order_relaxed)) {
+                max_pending_bytes_.store(pending, std::memory_order_relaxed);
+            }
+        }
+
+        void onError(boost::system::error_code ec) {
+            if (ec == boost::asio::error::operation_aborted) return;
+            std::cerr << "Market data connection " << index_ << " lost: " << ec.message() << std::endl;
+            connected_.store(false, std::memory_order_relaxed);
+            boost::beast::get_lowest_layer(*ws_).close();
+            buffer_.consume(buffer_.size());
+            scheduleReconnect();
+        }
+
+        // Exponential backoff; on success every symbol owned by this
+        // connection is resubscribed before reading resumes
+        void scheduleReconnect() {
+            timer_.expires_after(backoff_);
+            timer_.async_wait([this](boost::system::error_code ec) {
+                if (ec) return;
+                try {
+                    open();
+                } catch (const std::exception& e) {
+                    std::cerr << "Market data connection " << index_ << " reconnect failed: " << e.what() << std::endl;
+                    backoff_ = std::min(backoff_ * 2, kMaxBackoff);
+                    scheduleReconnect();
+                    return;
                 }
+                backoff_ = kMinBackoff;
+                reconnects_.fetch_add(1, std::memory_order_relaxed);
+                outbox_.clear();
+                pending_subscribe_ = symbols_;
+                writeNext();
+                asyncRead();
             });
-    }
+        }
+
+        MarketDataFeed& feed_;
+        size_t index_;
+        boost::asio::io_context ioc_;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+        boost::asio::steady_timer timer_;
+        std::unique_ptr<WebSocket> ws_;
+        boost::beast::flat_buffer buffer_;
+        std::thread thread_;
+        std::vector<SymbolId> symbols_;
+        std::vector<SymbolId> pending_subscribe_;
+        std::deque<std::string> outbox_;
+        bool writing_ = false;
+        std::chrono::milliseconds backoff_ = kMinBackoff;
 
-    void processMessage(const std::string& message) {
+        std::atomic<bool> connected_{false};
+        std::atomic<size_t> num_symbols_{0};
+        std::atomic<uint64_t> messages_{0};
+        std::atomic<uint64_t> bytes_{0};
+        std::atomic<uint64_t> fallback_parses_{0};
+        std::atomic<uint64_t> reconnects_{0};
+        std::atomic<size_t> pending_bytes_{0};
+        std::atomic<size_t> max_pending_bytes_{0};
+        std::atomic<double> max_handler_us_{0.0};
+    };
+
+    // Returns false when the frame needed the general JSON parser. Ticks for
+    // symbols this connection does not own are dropped, which keeps each
+    // quote slot single-writer.
+    bool processMessage(const char* data, size_t size, const Connection& connection) {
+        Tick tick;
+        if (TickDecoder::decode(data, size, tick)) {
+            SymbolId id = symbols_.find(tick.symbol);
+            if (id != kInvalidSymbol && connection.owns(id)) {
+                publish(id, tick.price, tick.volume, tick.bid, tick.ask, connection);
+            }
+            return true;
+        }
+
+        // Anything the scanner does not handle goes through the full parser
         try {
-            json j = json::parse(message);
-            MarketData data{
-                j["symbol"].get<std::string>(),
+            json j = json::parse(data, data + size);
+            // Ticks for symbols we never subscribed to have no slot
+            SymbolId id = symbols_.find(j["symbol"].get_ref<const std::string&>());
+            if (id == kInvalidSymbol || !connection.owns(id)) return false;
+
+            publish(id,
                 j["price"].get<double>(),
                 j["volume"].get<double>(),
                 j["bid"].get<double>(),
                 j["ask"].get<double>(),
-                std::chrono::system_clock::now()
-            };
-
-            std::lock_guard<std::mutex> lock(mutex_);
-            latest_data_[data.symbol] = data;
+                connection);
         } catch (const std::exception& e) {
             std::cerr << "Error processing market data: " << e.what() << std::endl;
         }
+        return false;
+    }
+
+    SymbolId internOrReject(std::string_view symbol) {
+        SymbolId id = symbols_.tryIntern(symbol);
+        if (id == kInvalidSymbol) {
+            std::cerr << "Symbol table full (" << symbols_.capacity()
+                      << " symbols), rejecting subscription to " << symbol << std::endl;
+        }
+        return id;
+    }
+
+    void publish(SymbolId id, double price, double volume, double bid, double ask,
+                 const Connection& connection) {
+        auto now = std::chrono::system_clock::now();
+        quotes_.update(id, price, volume, bid, ask, now);
+        if (quotes_.version(id) == 1) onFirstTick();
+        if (TickRecorder* recorder = recorder_.load(std::memory_order_acquire)) {
+            recorder->record(connection.index(), id, price, volume, bid, ask, now);
+        }
+        if (BarAggregator* bars = bars_.load(std::memory_order_acquire)) {
+            bars->push(connection.index(), id, price, volume,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           now.time_since_epoch()).count());
+        }
+    }
+
+    void markColdStart() {
+        int64_t expected = 0;
+        cold_start_begin_.compare_exchange_strong(
+            expected, std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    void onFirstTick() {
+        if (awaiting_first_tick_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::chrono::steady_clock::time_point begin(
+                std::chrono::steady_clock::duration(cold_start_begin_.load()));
+            cold_start_ms_.store(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - begin).count(), std::memory_order_release);
+        }
     }
 
-    boost::asio::io_context& ioc_;
-    std::unique_ptr<boost::beast::websocket::stream<boost::beast::tcp_stream>> ws_;
-    boost::beast::flat_buffer buffer_;
-    std::mutex mutex_;
-    std::map<std::string, MarketData> latest_data_;
+    std::string host_;
+    std::string port_;
+    SymbolTable symbols_;
+    QuoteTable quotes_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::unique_ptr<TickRecorder> capture_;
+    std::atomic<TickRecorder*> recorder_{nullptr};
+    std::atomic<BarAggregator*> bars_{nullptr};
+    std::atomic<size_t> awaiting_first_tick_{0};
+    std::atomic<int64_t> cold_start_begin_{0};
+    std::atomic<double> cold_start_ms_{-1.0};
 };
 
+// Portfolio risk over a window of asset returns. The return matrix is
+// stored asset-major, so the portfolio return series is built as one
+// unit-stride multiply-add per asset. Mean, variance and drawdown then come
+// out of a single fused pass, and VaR/CVaR from a partial selection rather
+// than a full sort. setReturns() once, then evaluate any number of weight
+// vectors against it, in parallel through evaluateBatch().
 class RiskManager {
 public:
     struct RiskMetrics {
@@ -97,65 +579,279 @@ public:
         double max_drawdown;
     };
 
-    RiskManager(double confidence_level = 0.95, int var_window = 252)
-        : confidence_level_(confidence_level), var_window_(var_window) {}
+    RiskManager(double confidence_level = 0.95, int var_window = 252, ThreadPool* pool = nullptr)
+        : confidence_level_(confidence_level), var_window_(var_window), pool_(pool) {}
 
-    RiskMetrics calculateRiskMetrics(const std::vector<double>& returns,
-                                   const std::vector<double>& weights) {
-        RiskMetrics metrics;
-        
-        // Calculate portfolio returns
-        std::vector<double> portfolio_returns(returns.size(), 0.0);
-        for (size_t i = 0; i < returns.size(); ++i) {
-            for (size_t j = 0; j < weights.size(); ++j) {
-                portfolio_returns[i] += returns[i] * weights[j];
+    // returns is a row-major periods x assets matrix, oldest period first;
+    // only the most recent var_window periods are kept
+    void setReturns(const double* returns, size_t periods, size_t assets) {
+        size_t first = periods > static_cast<size_t>(var_window_) ? periods - var_window_ : 0;
+        periods_ = periods - first;
+        assets_ = assets;
+        returns_by_asset_.resize(periods_ * assets_);
+        for (size_t t = 0; t < periods_; ++t) {
+            const double* row = returns + (first + t) * assets;
+            for (size_t j = 0; j < assets_; ++j) {
+                returns_by_asset_[j * periods_ + t] = row[j];
             }
         }
+    }
 
-        // Sort returns for VaR calculation
-        std::vector<double> sorted_returns = portfolio_returns;
-        std::sort(sorted_returns.begin(), sorted_returns.end());
+    size_t periods() const { return periods_; }
+    size_t assets() const { return assets_; }
 
-        // Calculate VaR
-        size_t var_index = static_cast<size_t>((1.0 - confidence_level_) * sorted_returns.size());
-        metrics.var = -sorted_returns[var_index];
+    RiskMetrics evaluate(const std::vector<double>& weights) {
+        return evaluate(weights.data(), scratch_);
+    }
+
+    // One metrics entry per weight vector; each worker gets its own scratch
+    void evaluateBatch(const std::vector<std::vector<double>>& weights,
+                       std::vector<RiskMetrics>& out) {
+        out.resize(weights.size());
+        size_t workers = pool_ ? pool_->size() : 1;
+        if (batch_scratch_.size() < workers) batch_scratch_.resize(workers);
 
-        // Calculate CVaR
-        double cvar_sum = 0.0;
-        size_t count = 0;
-        for (size_t i = 0; i < var_index; ++i) {
-            cvar_sum += sorted_returns[i];
-            ++count;
+        auto body = [&](size_t begin, size_t end, size_t worker) {
+            for (size_t k = begin; k < end; ++k) {
+                out[k] = evaluate(weights[k].data(), batch_scratch_[worker]);
+            }
+        };
+        if (pool_) {
+            pool_->parallelFor(0, weights.size(), 1, body);
+        } else {
+            body(0, weights.size(), 0);
         }
-        metrics.cvar = -cvar_sum / count;
+    }
 
-        // Calculate Sharpe Ratio
-        double mean_return = std::accumulate(portfolio_returns.begin(), 
-                                           portfolio_returns.end(), 0.0) / portfolio_returns.size();
-        double variance = 0.0;
-        for (double r : portfolio_returns) {
-            variance += (r - mean_return) * (r - mean_return);
+    // returns is a row-major periods x weights.size() matrix
+    RiskMetrics calculateRiskMetrics(const std::vector<double>& returns,
+                                   const std::vector<double>& weights) {
+        size_t assets = weights.size();
+        setReturns(returns.data(), assets ? returns.size() / assets : 0, assets);
+        return evaluate(weights);
+    }
+
+private:
+    RiskMetrics evaluate(const double* weights, kernels::AlignedVector<double>& portfolio) const {
+        RiskMetrics metrics{0.0, 0.0, 0.0, 0.0};
+        const size_t T = periods_;
+        if (T == 0) return metrics;
+
+        // Portfolio returns: p += w_j * r_j, one contiguous column per asset
+        portfolio.assign(T, 0.0);
+        double* p = portfolio.data();
+        const auto axpy = kernels::vectorKernels().axpy;
+        for (size_t j = 0; j < assets_; ++j) {
+            const double w = weights[j];
+            if (w == 0.0) continue;
+            axpy(w, returns_by_asset_.data() + j * periods_, p, T);
         }
-        variance /= (portfolio_returns.size() - 1);
-        double std_dev = std::sqrt(variance);
-        metrics.sharpe_ratio = mean_return / std_dev;
 
-        // Calculate Maximum Drawdown
-        double peak = portfolio_returns[0];
-        double max_drawdown = 0.0;
-        for (double r : portfolio_returns) {
-            if (r > peak) peak = r;
-            double drawdown = (peak - r) / peak;
-            if (drawdown > max_drawdown) max_drawdown = drawdown;
+        // Fused pass: Welford mean/variance and drawdown of compounded wealth
+        double mean = 0.0, m2 = 0.0;
+        double wealth = 1.0, peak = 1.0, max_drawdown = 0.0;
+        for (size_t t = 0; t < T; ++t) {
+            double r = p[t];
+            double delta = r - mean;
+            mean += delta / (t + 1);
+            m2 += delta * (r - mean);
+
+            wealth *= 1.0 + r;
+            peak = std::max(peak, wealth);
+            max_drawdown = std::max(max_drawdown, 1.0 - wealth / peak);
         }
+        double std_dev = T > 1 ? std::sqrt(m2 / (T - 1)) : 0.0;
+        metrics.sharpe_ratio = std_dev > 0.0 ? mean / std_dev : 0.0;
         metrics.max_drawdown = max_drawdown;
 
+        // VaR is the k-th smallest return; everything left of it after the
+        // selection is the tail CVaR averages over
+        size_t k = std::min(T - 1, static_cast<size_t>((1.0 - confidence_level_) * T));
+        std::nth_element(p, p + k, p + T);
+        metrics.var = -p[k];
+        if (k == 0) {
+            metrics.cvar = metrics.var;
+        } else {
+            double tail = 0.0;
+            for (size_t t = 0; t < k; ++t) {
+                tail += p[t];
+            }
+            metrics.cvar = -tail / k;
+        }
         return metrics;
     }
 
-private:
     double confidence_level_;
     int var_window_;
+    ThreadPool* pool_;
+    size_t periods_ = 0;
+    size_t assets_ = 0;
+    kernels::AlignedVector<double> returns_by_asset_;
+    kernels::AlignedVector<double> scratch_;
+    std::vector<kernels::AlignedVector<double>> batch_scratch_;
+};
+
+// Incremental counterpart of RiskManager for a single portfolio return
+// stream, so limits can be checked on every observation instead of once
+// per rebalance. VaR/CVaR cover the last `window` returns with the same
+// order statistic as RiskManager: the k smallest returns sit in a tail
+// multiset whose sum is kept alongside, and VaR is the smallest of the
+// rest, so an update costs O(log W). Mean and variance slide with
+// Welford's add/remove recurrences; both running sums are recomputed from
+// the ring once per window to shed rounding drift. Drawdown is tracked on
+// compounded wealth since construction or reset(), in O(1).
+class StreamingRiskMonitor {
+public:
+    StreamingRiskMonitor(double confidence_level = 0.95, size_t window = 252)
+        : confidence_level_(confidence_level), window_(std::max<size_t>(1, window)),
+          ring_(window_) {}
+
+    void update(double r) {
+        double* slot = ring_.data() + head_;
+        if (count_ == window_) {
+            double old = *slot;
+            eraseOrdered(old);
+            --count_;
+            if (count_ == 0) {
+                mean_ = m2_ = 0.0;
+            } else {
+                double delta = old - mean_;
+                mean_ -= delta / count_;
+                m2_ -= delta * (old - mean_);
+            }
+        }
+        *slot = r;
+        head_ = (head_ + 1) % window_;
+        ++count_;
+        ++updates_;
+
+        double delta = r - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (r - mean_);
+        insertOrdered(r);
+        rebalanceTail();
+
+        wealth_ *= 1.0 + r;
+        peak_ = std::max(peak_, wealth_);
+        max_drawdown_ = std::max(max_drawdown_, drawdown());
+
+        if (count_ == window_ && updates_ % window_ == 0) {
+            rebuild();
+        }
+    }
+
+    void reset() {
+        head_ = count_ = 0;
+        updates_ = 0;
+        mean_ = m2_ = tail_sum_ = 0.0;
+        tail_.clear();
+        rest_.clear();
+        wealth_ = peak_ = 1.0;
+        max_drawdown_ = 0.0;
+    }
+
+    size_t count() const { return count_; }
+    size_t window() const { return window_; }
+
+    double var() const {
+        return rest_.empty() ? 0.0 : -*rest_.begin();
+    }
+
+    double cvar() const {
+        return tail_.empty() ? var() : -tail_sum_ / tail_.size();
+    }
+
+    double sharpeRatio() const {
+        double std_dev = count_ > 1 ? std::sqrt(std::max(0.0, m2_) / (count_ - 1)) : 0.0;
+        return std_dev > 0.0 ? mean_ / std_dev : 0.0;
+    }
+
+    double drawdown() const {
+        return 1.0 - wealth_ / peak_;
+    }
+
+    double maxDrawdown() const {
+        return max_drawdown_;
+    }
+
+    RiskManager::RiskMetrics metrics() const {
+        return {var(), cvar(), sharpeRatio(), maxDrawdown()};
+    }
+
+private:
+    // Tail size for the current count, as in RiskManager::evaluate
+    size_t tailSize() const {
+        if (count_ == 0) return 0;
+        return std::min(count_ - 1, static_cast<size_t>((1.0 - confidence_level_) * count_));
+    }
+
+    void insertOrdered(double r) {
+        if (!tail_.empty() && r < *tail_.rbegin()) {
+            tail_.insert(r);
+            tail_sum_ += r;
+        } else {
+            rest_.insert(r);
+        }
+    }
+
+    void eraseOrdered(double r) {
+        if (!tail_.empty() && r <= *tail_.rbegin()) {
+            tail_.erase(tail_.find(r));
+            tail_sum_ -= r;
+        } else {
+            rest_.erase(rest_.find(r));
+        }
+    }
+
+    // Moves boundary elements until the tail holds exactly the k smallest
+    void rebalanceTail() {
+        size_t k = tailSize();
+        while (tail_.size() > k) {
+            auto largest = std::prev(tail_.end());
+            tail_sum_ -= *largest;
+            rest_.insert(*largest);
+            tail_.erase(largest);
+        }
+        while (tail_.size() < k) {
+            auto smallest = rest_.begin();
+            tail_sum_ += *smallest;
+            tail_.insert(*smallest);
+            rest_.erase(smallest);
+        }
+    }
+
+    void rebuild() {
+        mean_ = m2_ = 0.0;
+        size_t oldest = head_;  // The ring is full, so head_ is the oldest slot
+        for (size_t t = 0; t < count_; ++t) {
+            double r = ring_[(oldest + t) % window_];
+            double delta = r - mean_;
+            mean_ += delta / (t + 1);
+            m2_ += delta * (r - mean_);
+        }
+        tail_sum_ = 0.0;
+        for (double r : tail_) {
+            tail_sum_ += r;
+        }
+    }
+
+    double confidence_level_;
+    size_t window_;
+    std::vector<double> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    uint64_t updates_ = 0;
+
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+
+    std::multiset<double> tail_;
+    std::multiset<double> rest_;
+    double tail_sum_ = 0.0;
+
+    double wealth_ = 1.0;
+    double peak_ = 1.0;
+    double max_drawdown_ = 0.0;
 };
 
 } // namespace quantum_allocation
\ No newline at end of file
@@ -0,0 +1,483 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "StateVectorKernels.hpp"
+#include "ThreadPool.hpp"
+
+namespace quantum_allocation {
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11). Output is
+// a pure function of (counter, key), so scenario s always sees the same
+// numbers no matter which worker draws it or in what order.
+struct Philox4x32 {
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static Counter generate(Counter c, Key k) {
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = uint64_t(0xD2511F53u) * c[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57u) * c[2];
+            c = {uint32_t(p1 >> 32) ^ c[1] ^ k[0], uint32_t(p1),
+                 uint32_t(p0 >> 32) ^ c[3] ^ k[1], uint32_t(p0)};
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        return c;
+    }
+};
+
+namespace kernels {
+
+// Normal sampling for Monte Carlo: Philox words -> Box-Muller normals ->
+// dot products. Words are laid out in groups of 16, four counters per
+// group stored word-major (out[16g + 4w + lane] is word w of counter
+// 4g + lane), which is the order the SIMD generator produces them in.
+// Box-Muller pairs word i of each 8-word chunk with word i + 4.
+struct NormalKernels {
+    using PhiloxFn = void (*)(uint32_t* out, size_t groups, uint32_t c1, uint32_t c2,
+                              Philox4x32::Key key);
+    using BoxMullerFn = void (*)(const uint32_t* bits, double* z, size_t count);
+    using DotFn = double (*)(const double* a, const double* b, size_t n);
+
+    PhiloxFn philox;
+    BoxMullerFn boxMuller;
+    DotFn dot;
+    const char* name;
+};
+
+namespace detail {
+
+// Uniform in (0, 1): centred in its 2^-32 cell so the log never sees zero
+constexpr double kUnitScale = 1.0 / 4294967296.0;
+constexpr double kLn2 = 0.6931471805599453;
+constexpr double kTwoPi = 6.283185307179586;
+
+// fdlibm minimax coefficients: log(1+f) = 2s + s R(s^2), s = f / (2 + f);
+// sin and cos on [-pi/4, pi/4]
+constexpr double kLg[7] = {6.666666666666735130e-01, 3.999999999940941908e-01,
+                           2.857142874366239149e-01, 2.222219843214978396e-01,
+                           1.818357216161805012e-01, 1.531383769920937332e-01,
+                           1.479819860511658591e-01};
+constexpr double kSin[6] = {-1.66666666666666324348e-01, 8.33333333332248946124e-03,
+                            -1.98412698298579493134e-04, 2.75573137070700676789e-06,
+                            -2.50507602534068634195e-08, 1.58969099521155010221e-10};
+constexpr double kCos[6] = {4.16666666666666019037e-02, -1.38888888888741095749e-03,
+                            2.48015872894767294178e-05, -2.75573143513906633035e-07,
+                            2.08757232129817482790e-09, -1.13596475577881948265e-11};
+
+// Mantissa in [sqrt(1/2), sqrt(2)) after this bias is added to the bits
+constexpr uint64_t kLogBias = 0x3ff0000000000000ull - 0x3fe6a09e667f3bcdull;
+
+inline void philoxScalar(uint32_t* out, size_t groups, uint32_t c1, uint32_t c2,
+                         Philox4x32::Key key) {
+    for (size_t g = 0; g < groups; ++g) {
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            auto words = Philox4x32::generate({uint32_t(4 * g) + lane, c1, c2, 0}, key);
+            for (size_t w = 0; w < 4; ++w) {
+                out[16 * g + 4 * w + lane] = words[w];
+            }
+        }
+    }
+}
+
+inline double logUnit(double u) {
+    uint64_t bits;
+    std::memcpy(&bits, &u, sizeof(bits));
+    bits += kLogBias;
+    double e = static_cast<double>(static_cast<int64_t>(bits >> 52) - 1023);
+    bits = (bits & 0x000fffffffffffffull) + 0x3fe6a09e667f3bcdull;
+    double m;
+    std::memcpy(&m, &bits, sizeof(m));
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double r = kLg[6];
+    for (int i = 5; i >= 0; --i) r = r * z + kLg[i];
+    return e * kLn2 + (2.0 * s + s * (r * z));
+}
+
+// cos and sin of 2 pi u by quadrant: u - q/4 is exact for our uniforms
+inline void sinCosUnit(double u, double& sin_out, double& cos_out) {
+    double q = std::nearbyint(4.0 * u);
+    double x = kTwoPi * (u - 0.25 * q);
+    double x2 = x * x;
+    double ps = kSin[5], pc = kCos[5];
+    for (int i = 4; i >= 0; --i) {
+        ps = ps * x2 + kSin[i];
+        pc = pc * x2 + kCos[i];
+    }
+    double s = x + x * x2 * ps;
+    double c = 1.0 - 0.5 * x2 + x2 * x2 * pc;
+    int quadrant = static_cast<int>(q) & 3;
+    double sin_q = (quadrant & 1) ? c : s;
+    double cos_q = (quadrant & 1) ? s : c;
+    sin_out = quadrant >= 2 ? -sin_q : sin_q;
+    cos_out = (quadrant == 1 || quadrant == 2) ? -cos_q : cos_q;
+}
+
+inline void boxMullerScalar(const uint32_t* bits, double* z, size_t count) {
+    for (size_t chunk = 0; chunk < count; chunk += 8) {
+        for (size_t i = 0; i < 4; ++i) {
+            double u1 = (bits[chunk + i] + 0.5) * kUnitScale;
+            double u2 = (bits[chunk + 4 + i] + 0.5) * kUnitScale;
+            double radius = std::sqrt(-2.0 * logUnit(u1));
+            double s, c;
+            sinCosUnit(u2, s, c);
+            z[chunk + i] = radius * c;
+            z[chunk + 4 + i] = radius * s;
+        }
+    }
+}
+
+inline double dotScalar(const double* a, const double* b, size_t n) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        for (size_t k = 0; k < 4; ++k) acc[k] += a[j + k] * b[j + k];
+    }
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    for (; j < n; ++j) sum += a[j] * b[j];
+    return sum;
+}
+
+#ifdef QUARTZ_X86_SIMD
+
+// Four counters per register, one 32-bit word per 64-bit lane so
+// _mm256_mul_epu32 yields the full 64-bit products
+__attribute__((target("avx2,fma")))
+inline void philoxAvx2(uint32_t* out, size_t groups, uint32_t c1, uint32_t c2,
+                       Philox4x32::Key key) {
+    const __m256i m0 = _mm256_set1_epi64x(0xD2511F53u);
+    const __m256i m1 = _mm256_set1_epi64x(0xCD9E8D57u);
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFFu);
+    const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    for (size_t g = 0; g < groups; ++g) {
+        uint32_t base = uint32_t(4 * g);
+        __m256i x0 = _mm256_setr_epi64x(base, base + 1, base + 2, base + 3);
+        __m256i x1 = _mm256_set1_epi64x(c1);
+        __m256i x2 = _mm256_set1_epi64x(c2);
+        __m256i x3 = _mm256_setzero_si256();
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round) {
+            __m256i p0 = _mm256_mul_epu32(x0, m0);
+            __m256i p1 = _mm256_mul_epu32(x2, m1);
+            x0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), x1),
+                                  _mm256_set1_epi64x(k0));
+            x1 = _mm256_and_si256(p1, low);
+            x2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), x3),
+                                  _mm256_set1_epi64x(k1));
+            x3 = _mm256_and_si256(p0, low);
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        uint32_t* dst = out + 16 * g;
+        const __m256i words[4] = {x0, x1, x2, x3};
+        for (size_t w = 0; w < 4; ++w) {
+            __m256i packed = _mm256_permutevar8x32_epi32(words[w], pack);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * w),
+                             _mm256_castsi256_si128(packed));
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256d uniformAvx2(const uint32_t* bits) {
+    // Unsigned to double via the signed conversion, then shift back by 2^31
+    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bits)),
+                              _mm_set1_epi32(int(0x80000000u)));
+    __m256d d = _mm256_add_pd(_mm256_cvtepi32_pd(x), _mm256_set1_pd(2147483648.5));
+    return _mm256_mul_pd(d, _mm256_set1_pd(kUnitScale));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256d logUnitAvx2(__m256d u) {
+    __m256i bits = _mm256_add_epi64(_mm256_castpd_si256(u),
+                                    _mm256_set1_epi64x(static_cast<long long>(kLogBias)));
+    // Exponent to double through the 2^52 magic constant
+    __m256d e = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52),
+                                            _mm256_set1_epi64x(0x4330000000000000ll))),
+        _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    __m256i mantissa = _mm256_add_epi64(
+        _mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffll)),
+        _mm256_set1_epi64x(0x3fe6a09e667f3bcdll));
+    __m256d f = _mm256_sub_pd(_mm256_castsi256_pd(mantissa), _mm256_set1_pd(1.0));
+    __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d r = _mm256_set1_pd(kLg[6]);
+    for (int i = 5; i >= 0; --i) r = _mm256_fmadd_pd(r, z, _mm256_set1_pd(kLg[i]));
+    __m256d log1pf = _mm256_fmadd_pd(s, _mm256_mul_pd(r, z), _mm256_add_pd(s, s));
+    return _mm256_fmadd_pd(e, _mm256_set1_pd(kLn2), log1pf);
+}
+
+__attribute__((target("avx2,fma")))
+inline void boxMullerAvx2(const uint32_t* bits, double* z, size_t count) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    for (size_t chunk = 0; chunk < count; chunk += 8) {
+        __m256d u1 = uniformAvx2(bits + chunk);
+        __m256d u2 = uniformAvx2(bits + chunk + 4);
+        __m256d radius = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_set1_pd(-2.0), logUnitAvx2(u1)));
+
+        __m256d q = _mm256_round_pd(_mm256_mul_pd(_mm256_set1_pd(4.0), u2),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d x = _mm256_mul_pd(_mm256_set1_pd(kTwoPi),
+                                  _mm256_fnmadd_pd(_mm256_set1_pd(0.25), q, u2));
+        __m256d x2 = _mm256_mul_pd(x, x);
+        __m256d ps = _mm256_set1_pd(kSin[5]), pc = _mm256_set1_pd(kCos[5]);
+        for (int i = 4; i >= 0; --i) {
+            ps = _mm256_fmadd_pd(ps, x2, _mm256_set1_pd(kSin[i]));
+            pc = _mm256_fmadd_pd(pc, x2, _mm256_set1_pd(kCos[i]));
+        }
+        __m256d s = _mm256_fmadd_pd(_mm256_mul_pd(x, x2), ps, x);
+        __m256d c = _mm256_fmadd_pd(_mm256_mul_pd(x2, x2), pc,
+                                    _mm256_fnmadd_pd(_mm256_set1_pd(0.5), x2, _mm256_set1_pd(1.0)));
+
+        // Quadrant 0..4 (4 wraps to 0): odd swaps sin/cos, 2-3 negate sin,
+        // 1-2 negate cos
+        __m256d odd = _mm256_cmp_pd(q, _mm256_set1_pd(1.0), _CMP_EQ_OQ);
+        odd = _mm256_or_pd(odd, _mm256_cmp_pd(q, _mm256_set1_pd(3.0), _CMP_EQ_OQ));
+        __m256d neg_sin = _mm256_and_pd(_mm256_cmp_pd(q, _mm256_set1_pd(2.0), _CMP_GE_OQ),
+                                        _mm256_cmp_pd(q, _mm256_set1_pd(3.0), _CMP_LE_OQ));
+        __m256d neg_cos = _mm256_and_pd(_mm256_cmp_pd(q, _mm256_set1_pd(1.0), _CMP_GE_OQ),
+                                        _mm256_cmp_pd(q, _mm256_set1_pd(2.0), _CMP_LE_OQ));
+        __m256d sin_q = _mm256_blendv_pd(s, c, odd);
+        __m256d cos_q = _mm256_blendv_pd(c, s, odd);
+        sin_q = _mm256_xor_pd(sin_q, _mm256_and_pd(neg_sin, sign));
+        cos_q = _mm256_xor_pd(cos_q, _mm256_and_pd(neg_cos, sign));
+
+        _mm256_storeu_pd(z + chunk, _mm256_mul_pd(radius, cos_q));
+        _mm256_storeu_pd(z + chunk + 4, _mm256_mul_pd(radius, sin_q));
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline double dotAvx2(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 4), _mm256_loadu_pd(b + j + 4), acc1);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; j < n; ++j) sum += a[j] * b[j];
+    return sum;
+}
+
+#endif // QUARTZ_X86_SIMD
+
+inline NormalKernels selectNormalKernels() {
+#ifdef QUARTZ_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {philoxAvx2, boxMullerAvx2, dotAvx2, "avx2"};
+    }
+#endif
+    return {philoxScalar, boxMullerScalar, dotScalar, "scalar"};
+}
+
+} // namespace detail
+
+// Best sampling kernels for the running CPU, picked once via CPUID
+inline const NormalKernels& normalKernels() {
+    static const NormalKernels table = detail::selectNormalKernels();
+    return table;
+}
+
+} // namespace kernels
+
+// Monte Carlo VaR/CVaR of a linear portfolio under a multivariate normal
+// return model. The covariance is factored once (Cholesky, L L' = Sigma)
+// and the factor is reused until the covariance changes. For weights w the
+// scenario return is mu'w + (L'w)'z with z ~ N(0, I), so v = L'w is formed
+// once per evaluation and each scenario costs n normals and one dot
+// product rather than a matrix-vector multiply.
+//
+// Scenarios are generated in blocks: raw Philox words for the whole block
+// first, then Box-Muller over the block, then the dot products, each with
+// an AVX2 kernel where available. Blocks are spread over the thread pool;
+// since scenario s is keyed by its index, results are bit-identical for
+// any worker count on a given kernel set (scalar and AVX2 agree to a few
+// ulps, not bit for bit).
+class MonteCarloVaR {
+public:
+    struct Settings {
+        size_t scenarios = 100000;
+        uint64_t seed = 0x5EED;
+        double confidence_level = 0.95;
+    };
+
+    struct Result {
+        double var = 0.0;   // Loss at the confidence level
+        double cvar = 0.0;  // Mean loss beyond it
+        double mean = 0.0;  // Mean simulated return
+        double std_dev = 0.0;
+        size_t scenarios = 0;
+    };
+
+    explicit MonteCarloVaR(const Settings& settings, ThreadPool* pool = nullptr)
+        : settings_(settings), pool_(pool) {}
+
+    // Refactors only if the covariance differs from the cached one;
+    // returns true when it did
+    bool setCovariance(const std::vector<std::vector<double>>& covariance) {
+        size_t n = covariance.size();
+        bool same = n == n_;
+        for (size_t i = 0; same && i < n; ++i) {
+            same = std::equal(covariance[i].begin(), covariance[i].begin() + i + 1,
+                              cached_.begin() + i * n);
+        }
+        if (same) return false;
+
+        n_ = n;
+        cached_.assign(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            std::copy(covariance[i].begin(), covariance[i].begin() + i + 1, cached_.begin() + i * n);
+        }
+        factor();
+        ++factorizations_;
+        return true;
+    }
+
+    size_t numAssets() const { return n_; }
+    uint64_t factorizations() const { return factorizations_; }
+
+    Result evaluate(const std::vector<double>& weights, const std::vector<double>& mean_returns) {
+        Result result;
+        const size_t S = settings_.scenarios;
+        if (n_ == 0 || S == 0 || weights.size() != n_) return result;
+
+        // v_j = sum_{i >= j} L_ij w_i, one row axpy per asset
+        v_.assign(n_, 0.0);
+        double mu = 0.0;
+        for (size_t i = 0; i < n_; ++i) {
+            const double w = weights[i];
+            if (i < mean_returns.size()) mu += w * mean_returns[i];
+            if (w == 0.0) continue;
+            const double* row = factor_.data() + i * n_;
+            for (size_t j = 0; j <= i; ++j) {
+                v_[j] += row[j] * w;
+            }
+        }
+
+        returns_.resize(S);
+        size_t blocks = (S + kBlock - 1) / kBlock;
+        size_t workers = pool_ ? pool_->size() : 1;
+        if (scratch_.size() < workers) scratch_.resize(workers);
+
+        auto body = [&](size_t begin, size_t end, size_t worker) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t first = b * kBlock;
+                simulate(first, std::min(S, first + kBlock), mu, scratch_[worker]);
+            }
+        };
+        if (pool_) {
+            pool_->parallelFor(0, blocks, 1, body);
+        } else {
+            body(0, blocks, 0);
+        }
+
+        double* r = returns_.data();
+        double sum = 0.0;
+        for (size_t s = 0; s < S; ++s) {
+            sum += r[s];
+        }
+        double mean = sum / S, sum_sq = 0.0;
+        for (size_t s = 0; s < S; ++s) {
+            sum_sq += (r[s] - mean) * (r[s] - mean);
+        }
+        result.scenarios = S;
+        result.mean = mean;
+        result.std_dev = S > 1 ? std::sqrt(sum_sq / (S - 1)) : 0.0;
+
+        // Same order statistic as RiskManager's historical VaR
+        size_t k = std::min(S - 1, static_cast<size_t>((1.0 - settings_.confidence_level) * S));
+        std::nth_element(r, r + k, r + S);
+        result.var = -r[k];
+        if (k == 0) {
+            result.cvar = result.var;
+        } else {
+            double tail = 0.0;
+            for (size_t s = 0; s < k; ++s) {
+                tail += r[s];
+            }
+            result.cvar = -tail / k;
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t kBlock = 256;  // Scenarios per work item
+
+    struct Scratch {
+        std::vector<uint32_t> bits;
+        kernels::AlignedVector<double> normals;
+    };
+
+    // Lower Cholesky factor, row-major. A non-positive pivot (a singular
+    // sample covariance, e.g. fewer bars than assets) zeroes that column,
+    // which keeps the factor exact for positive semi-definite input.
+    void factor() {
+        factor_.assign(n_ * n_, 0.0);
+        double* L = factor_.data();
+        for (size_t j = 0; j < n_; ++j) {
+            const double* lj = L + j * n_;
+            double d = cached_[j * n_ + j];
+            for (size_t k = 0; k < j; ++k) {
+                d -= lj[k] * lj[k];
+            }
+            double scale = cached_[j * n_ + j] > 0.0 ? cached_[j * n_ + j] : 1.0;
+            if (d <= kPivotTolerance * scale) continue;
+            double pivot = std::sqrt(d);
+            L[j * n_ + j] = pivot;
+            for (size_t i = j + 1; i < n_; ++i) {
+                double* li = L + i * n_;
+                double x = cached_[i * n_ + j];
+                for (size_t k = 0; k < j; ++k) {
+                    x -= li[k] * lj[k];
+                }
+                li[j] = x / pivot;
+            }
+        }
+    }
+
+    void simulate(size_t first, size_t last, double mu, Scratch& scratch) {
+        const auto& sampler = kernels::normalKernels();
+        const size_t count = last - first;
+        const size_t stride = (n_ + 15) & ~size_t(15);  // Normals per scenario, whole Philox groups
+        scratch.bits.resize(count * stride);
+        scratch.normals.resize(count * stride);
+
+        const Philox4x32::Key key = {uint32_t(settings_.seed), uint32_t(settings_.seed >> 32)};
+        for (size_t s = 0; s < count; ++s) {
+            uint64_t scenario = first + s;
+            sampler.philox(scratch.bits.data() + s * stride, stride / 16, uint32_t(scenario),
+                           uint32_t(scenario >> 32), key);
+        }
+        sampler.boxMuller(scratch.bits.data(), scratch.normals.data(), count * stride);
+
+        for (size_t s = 0; s < count; ++s) {
+            returns_[first + s] = mu + sampler.dot(v_.data(), scratch.normals.data() + s * stride, n_);
+        }
+    }
+
+    static constexpr double kPivotTolerance = 1e-12;
+
+    Settings settings_;
+    ThreadPool* pool_;
+    size_t n_ = 0;
+    uint64_t factorizations_ = 0;
+    std::vector<double> cached_;           // Lower triangle of the covariance, row-major
+    kernels::AlignedVector<double> factor_;
+    kernels::AlignedVector<double> v_;
+    std::vector<double> returns_;  // Simulated portfolio returns, by scenario index
+    std::vector<Scratch> scratch_;
+};
+
+} // namespace quantum_allocation
@@ -0,0 +1,443 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "QuoteTable.hpp"
+#include "RiskGate.hpp"
+
+namespace quantum_allocation {
+
+// One message the order manager wants sent. order_id is filled in by the
+// sender; for Replace and Cancel, orig_order_id names the working order.
+struct OrderAction {
+    enum class Type : uint8_t { New, Replace, Cancel };
+
+    Type type = Type::New;
+    SymbolId symbol = kInvalidSymbol;
+    char side = 0;             // FIX side: '1' buy, '2' sell
+    double quantity = 0.0;     // Total order quantity after the action
+    double leaves_delta = 0.0; // Change in open quantity (New: +quantity)
+    double price = 0.0;
+    uint64_t order_id = 0;
+    uint64_t orig_order_id = 0;
+    RiskCheck result = RiskCheck::Accepted;
+};
+
+// Open quantity that stopped counting against limits, for the risk gate
+struct ReleasedQuantity {
+    SymbolId symbol = kInvalidSymbol;
+    char side = 0;
+    double quantity = 0.0;
+    double price = 0.0;
+};
+
+// Tracks working orders from execution reports and nets each rebalance's
+// target deltas against them, so a symbol whose order is already working
+// at about the right size and price costs no message at all, and one that
+// needs adjusting is amended in place instead of cancelled and resent.
+//
+// Each symbol has at most one working order. An order with a request in
+// flight is left alone until the venue answers; a delta on the other side
+// first cancels the working order and the opposite order goes out on a
+// later rebalance, so the book never crosses itself.
+//
+// Orders live in a flat pool; a linear-probing index keyed by the numeric
+// part of the ClOrdID finds them from reports. While a replace is pending
+// both the old and the new ClOrdID map to the same order. One mutex covers
+// both sides: the execute stage plans and records, the FIX thread reports.
+class OrderManager {
+public:
+    struct Settings {
+        double min_quantity = 1.0;         // Smaller deltas and differences are ignored
+        double price_tolerance = 0.0005;   // Relative price move that is worth an amend
+        size_t initial_capacity = 4096;    // Live orders before the index grows
+    };
+
+    struct Counters {
+        uint64_t sent_new = 0;
+        uint64_t sent_replace = 0;
+        uint64_t sent_cancel = 0;
+        uint64_t netted = 0;     // Deltas already covered by a working order
+        uint64_t in_flight = 0;  // Deltas skipped while a request was outstanding
+        uint64_t stale = 0;      // Actions dropped because the order changed after net()
+    };
+
+    OrderManager(size_t symbol_capacity, const Settings& settings)
+        : settings_(settings), live_(symbol_capacity, kNoOrder) {
+        resizeIndex(indexSizeFor(settings_.initial_capacity));
+        pool_.reserve(settings_.initial_capacity);
+    }
+
+    OrderManager(const OrderManager&) = delete;
+    OrderManager& operator=(const OrderManager&) = delete;
+
+    // Appends what it takes to move the symbol's open quantity to
+    // signed_quantity (positive buys) at price
+    void net(SymbolId symbol, double signed_quantity, double price, std::vector<OrderAction>& batch) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (symbol >= live_.size()) return;
+        const double wanted = std::abs(signed_quantity);
+        const char side = signed_quantity > 0.0 ? kBuy : kSell;
+
+        uint32_t slot = live_[symbol];
+        if (slot == kNoOrder) {
+            if (wanted < settings_.min_quantity) return;
+            OrderAction action;
+            action.type = OrderAction::Type::New;
+            action.symbol = symbol;
+            action.side = side;
+            action.quantity = wanted;
+            action.leaves_delta = wanted;
+            action.price = price;
+            batch.push_back(action);
+            return;
+        }
+
+        const Order& order = pool_[slot];
+        if (order.state != State::Working) {
+            ++counters_.in_flight;
+            return;
+        }
+        const double leaves = order.quantity - order.filled;
+        if (wanted < settings_.min_quantity || side != order.side) {
+            OrderAction action;
+            action.type = OrderAction::Type::Cancel;
+            action.symbol = symbol;
+            action.side = order.side;
+            action.quantity = order.quantity;
+            action.leaves_delta = -leaves;
+            action.price = order.price;
+            action.orig_order_id = order.order_id;
+            batch.push_back(action);
+            return;
+        }
+
+        bool size_ok = std::abs(wanted - leaves) < settings_.min_quantity;
+        bool price_ok = std::abs(price - order.price) <= settings_.price_tolerance * order.price;
+        if (size_ok && price_ok) {
+            ++counters_.netted;
+            return;
+        }
+        OrderAction action;
+        action.type = OrderAction::Type::Replace;
+        action.symbol = symbol;
+        action.side = side;
+        action.quantity = order.filled + wanted;
+        action.leaves_delta = wanted - leaves;
+        action.price = price;
+        action.orig_order_id = order.order_id;
+        batch.push_back(action);
+    }
+
+    // Records an action before it is handed to the session, so reports
+    // that race back on the FIX thread always find the order and its
+    // pending quantity and price. Returns false if the action went stale
+    // after net(): the order it amends or cancels has finished or has
+    // another request outstanding. Stale actions must not be sent.
+    bool onSending(const OrderAction& action) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        switch (action.type) {
+        case OrderAction::Type::New: {
+            if (action.symbol >= live_.size() || live_[action.symbol] != kNoOrder) {
+                ++counters_.stale;
+                return false;
+            }
+            uint32_t slot = allocate();
+            Order& order = pool_[slot];
+            order = Order{};
+            order.order_id = action.order_id;
+            order.symbol = action.symbol;
+            order.side = action.side;
+            order.quantity = action.quantity;
+            order.price = action.price;
+            order.state = State::PendingNew;
+            live_[action.symbol] = slot;
+            insert(action.order_id, slot);
+            ++counters_.sent_new;
+            return true;
+        }
+        case OrderAction::Type::Replace: {
+            uint32_t slot = workingOrder(action.orig_order_id);
+            if (slot == kNoOrder || action.quantity - pool_[slot].filled < kQuantityEpsilon) {
+                ++counters_.stale;
+                return false;
+            }
+            Order& order = pool_[slot];
+            order.state = State::PendingReplace;
+            order.pending_id = action.order_id;
+            order.pending_quantity = action.quantity;
+            order.pending_price = action.price;
+            insert(action.order_id, slot);
+            ++counters_.sent_replace;
+            return true;
+        }
+        case OrderAction::Type::Cancel: {
+            uint32_t slot = workingOrder(action.orig_order_id);
+            if (slot == kNoOrder) {
+                ++counters_.stale;
+                return false;
+            }
+            Order& order = pool_[slot];
+            order.state = State::PendingCancel;
+            order.pending_id = action.order_id;
+            insert(action.order_id, slot);
+            ++counters_.sent_cancel;
+            return true;
+        }
+        }
+        return false;
+    }
+
+    // Undoes onSending for an action the session did not take
+    void onSendFailed(const OrderAction& action) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = find(action.order_id);
+        if (slot == kNoOrder) return;
+        Order& order = pool_[slot];
+        switch (action.type) {
+        case OrderAction::Type::New:
+            retire(slot);
+            --counters_.sent_new;
+            break;
+        case OrderAction::Type::Replace:
+        case OrderAction::Type::Cancel:
+            if (order.pending_id != action.order_id) return;
+            erase(action.order_id);
+            order.pending_id = 0;
+            order.state = State::Working;
+            --(action.type == OrderAction::Type::Replace ? counters_.sent_replace
+                                                         : counters_.sent_cancel);
+            break;
+        }
+    }
+
+    void onAck(uint64_t order_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = find(order_id);
+        if (slot != kNoOrder && pool_[slot].state == State::PendingNew) {
+            pool_[slot].state = State::Working;
+        }
+    }
+
+    void onFill(uint64_t order_id, double quantity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = find(order_id);
+        if (slot == kNoOrder) return;
+        Order& order = pool_[slot];
+        order.filled += quantity;
+        if (order.state == State::PendingNew) order.state = State::Working;
+        if (order.quantity - order.filled < kQuantityEpsilon && order.state == State::Working) {
+            retire(slot);
+        }
+    }
+
+    // The venue accepted a replace: the new ClOrdID takes over. A smaller
+    // order releases the difference.
+    ReleasedQuantity onReplaced(uint64_t orig_order_id, uint64_t order_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ReleasedQuantity released;
+        uint32_t slot = find(order_id);
+        if (slot == kNoOrder) slot = find(orig_order_id);
+        if (slot == kNoOrder) return released;
+        Order& order = pool_[slot];
+        double old_leaves = order.quantity - order.filled;
+        double new_leaves = order.pending_quantity - order.filled;
+        if (new_leaves < old_leaves) {
+            released = {order.symbol, order.side, old_leaves - new_leaves, order.price};
+        }
+        erase(order.order_id);
+        order.order_id = order.pending_id;
+        order.pending_id = 0;
+        order.quantity = order.pending_quantity;
+        order.price = order.pending_price;
+        order.state = State::Working;
+        if (order.quantity - order.filled < kQuantityEpsilon) retire(slot);
+        return released;
+    }
+
+    // A cancel or replace request was refused; the order keeps working
+    // as it was. A refused replace that would have grown the order gives
+    // back what was reserved for it.
+    ReleasedQuantity onCancelReject(uint64_t request_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ReleasedQuantity released;
+        uint32_t slot = find(request_id);
+        if (slot == kNoOrder) return released;
+        Order& order = pool_[slot];
+        if (order.pending_id != request_id) return released;
+        if (order.state == State::PendingReplace && order.pending_quantity > order.quantity) {
+            released = {order.symbol, order.side, order.pending_quantity - order.quantity,
+                        order.pending_price};
+        }
+        erase(request_id);
+        order.pending_id = 0;
+        order.state = State::Working;
+        if (order.quantity - order.filled < kQuantityEpsilon) retire(slot);
+        return released;
+    }
+
+    // Cancelled, expired or rejected: the order is gone
+    void onDone(uint64_t order_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = find(order_id);
+        if (slot != kNoOrder) retire(slot);
+    }
+
+    // Signed open quantity of the symbol's working order (0 if none)
+    double openQuantity(SymbolId symbol) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (symbol >= live_.size() || live_[symbol] == kNoOrder) return 0.0;
+        const Order& order = pool_[live_[symbol]];
+        double leaves = order.quantity - order.filled;
+        return order.side == kBuy ? leaves : -leaves;
+    }
+
+    size_t liveOrders() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return live_count_;
+    }
+
+    Counters counters() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counters_;
+    }
+
+private:
+    static constexpr char kBuy = '1';
+    static constexpr char kSell = '2';
+    static constexpr uint32_t kNoOrder = ~uint32_t(0);
+    static constexpr uint64_t kEmpty = 0;  // ClOrdID numbers start at 1
+    static constexpr uint64_t kTombstone = ~uint64_t(0);
+    static constexpr double kQuantityEpsilon = 1e-9;
+
+    enum class State : uint8_t { PendingNew, Working, PendingReplace, PendingCancel };
+
+    struct Order {
+        uint64_t order_id = 0;
+        uint64_t pending_id = 0;  // ClOrdID of the outstanding replace/cancel
+        SymbolId symbol = kInvalidSymbol;
+        char side = 0;
+        State state = State::PendingNew;
+        double quantity = 0.0;
+        double filled = 0.0;
+        double price = 0.0;
+        double pending_quantity = 0.0;
+        double pending_price = 0.0;
+    };
+
+    struct Entry {
+        uint64_t key = kEmpty;
+        uint32_t slot = kNoOrder;
+    };
+
+    static size_t indexSizeFor(size_t orders) {
+        size_t n = 16;
+        while (n < 4 * orders) n <<= 1;
+        return n;
+    }
+
+    // Fibonacci hashing spreads sequential IDs across the table
+    size_t bucket(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    // Slot of a working order still known by order_id, or kNoOrder
+    uint32_t workingOrder(uint64_t order_id) const {
+        uint32_t slot = find(order_id);
+        if (slot == kNoOrder) return kNoOrder;
+        const Order& order = pool_[slot];
+        return order.order_id == order_id && order.state == State::Working ? slot : kNoOrder;
+    }
+
+    uint32_t find(uint64_t key) const {
+        if (key == kEmpty || key == kTombstone) return kNoOrder;
+        for (size_t b = bucket(key);; b = (b + 1) & mask_) {
+            const Entry& entry = index_[b];
+            if (entry.key == key) return entry.slot;
+            if (entry.key == kEmpty) return kNoOrder;
+        }
+    }
+
+    void insert(uint64_t key, uint32_t slot) {
+        // Keys plus tombstones stay under half the table, so probes stay short
+        if (2 * (used_ + 1) > index_.size()) {
+            resizeIndex(indexSizeFor(std::max<size_t>(keys_ + 1, settings_.initial_capacity)));
+        }
+        size_t b = bucket(key);
+        while (index_[b].key != kEmpty && index_[b].key != kTombstone) {
+            b = (b + 1) & mask_;
+        }
+        if (index_[b].key == kEmpty) ++used_;
+        index_[b] = {key, slot};
+        ++keys_;
+    }
+
+    void erase(uint64_t key) {
+        if (key == kEmpty) return;
+        for (size_t b = bucket(key);; b = (b + 1) & mask_) {
+            Entry& entry = index_[b];
+            if (entry.key == kEmpty) return;
+            if (entry.key == key) {
+                entry.key = kTombstone;
+                --keys_;
+                return;
+            }
+        }
+    }
+
+    void resizeIndex(size_t size) {
+        std::vector<Entry> old;
+        old.swap(index_);
+        index_.assign(size, Entry{});
+        mask_ = size - 1;
+        shift_ = 64;
+        for (size_t n = size; n > 1; n >>= 1) --shift_;
+        used_ = keys_ = 0;
+        for (const Entry& entry : old) {
+            if (entry.key != kEmpty && entry.key != kTombstone) insert(entry.key, entry.slot);
+        }
+    }
+
+    uint32_t allocate() {
+        ++live_count_;
+        if (!free_.empty()) {
+            uint32_t slot = free_.back();
+            free_.pop_back();
+            return slot;
+        }
+        pool_.emplace_back();
+        return static_cast<uint32_t>(pool_.size() - 1);
+    }
+
+    void retire(uint32_t slot) {
+        Order& order = pool_[slot];
+        erase(order.order_id);
+        erase(order.pending_id);
+        if (order.symbol < live_.size() && live_[order.symbol] == slot) {
+            live_[order.symbol] = kNoOrder;
+        }
+        order.order_id = order.pending_id = 0;
+        order.symbol = kInvalidSymbol;
+        free_.push_back(slot);
+        --live_count_;
+    }
+
+    Settings settings_;
+    mutable std::mutex mutex_;
+    std::vector<Order> pool_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> live_;  // Working order per symbol, kNoOrder if none
+    std::vector<Entry> index_;
+    size_t mask_ = 0;
+    int shift_ = 64;
+    size_t used_ = 0;  // Keys plus tombstones
+    size_t keys_ = 0;
+    size_t live_count_ = 0;
+    Counters counters_;
+};
+
+} // namespace quantum_allocation
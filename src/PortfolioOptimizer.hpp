@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+namespace quantum_allocation {
+
+struct OptimizationParameters {
+    double risk_aversion;
+    double temperature;
+    int num_iterations;
+    double learning_rate;
+    // Stop once the allocation moves less than this between checks (0 = off)
+    double convergence_tolerance = 0.0;
+    // Seed each optimize() from the previous call's state instead of starting over
+    bool warm_start = false;
+};
+
+// What the last optimize() call actually did
+struct OptimizationStats {
+    int iterations_run = 0;
+    int iteration_budget = 0;
+    bool converged = false;
+    double elapsed_ms = 0.0;
+    double saved_ms = 0.0;  // Estimated time the skipped iterations would have taken
+};
+
+// Common interface for allocation backends selected from config.yaml
+class PortfolioOptimizer {
+public:
+    virtual ~PortfolioOptimizer() = default;
+
+    // Target weights for the given expected returns and covariance matrix
+    virtual std::vector<double> optimize(const std::vector<double>& returns,
+                                         const std::vector<std::vector<double>>& covariance) = 0;
+
+    virtual const char* name() const = 0;
+
+    const OptimizationStats& lastStats() const {
+        return stats_;
+    }
+
+protected:
+    void recordStats(int iterations_run, int iteration_budget, bool converged,
+                     double elapsed_ms) {
+        stats_.iterations_run = iterations_run;
+        stats_.iteration_budget = iteration_budget;
+        stats_.converged = converged;
+        stats_.elapsed_ms = elapsed_ms;
+        stats_.saved_ms = iterations_run > 0
+            ? elapsed_ms / iterations_run * (iteration_budget - iterations_run)
+            : 0.0;
+    }
+
+private:
+    OptimizationStats stats_;
+};
+
+} // namespace quantum_allocation
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "QuoteTable.hpp"
+
+namespace quantum_allocation {
+
+// Filled positions per symbol ID, written by the FIX thread as execution
+// reports arrive and read by the strategy without locks. Each slot is a
+// seqlock on its own cache line, as in QuoteTable: the writer makes the
+// sequence odd, updates the fields and makes it even again; readers retry
+// if it moved. A read is a handful of loads, so a rebalance can query
+// every symbol without slowing the fill path.
+//
+// Average price is the weighted cost of the open quantity. Fills that
+// reduce a position realize (price - average) on the closed part; a fill
+// that crosses zero closes the old position and opens the remainder at
+// the fill price.
+class PositionBook {
+public:
+    struct Position {
+        double quantity = 0.0;       // Signed, positive long
+        double average_price = 0.0;  // 0 when flat
+        double realized_pnl = 0.0;
+        double last_fill_price = 0.0;
+        uint64_t fills = 0;
+        uint64_t version = 0;
+
+        double unrealizedPnl(double mark) const {
+            return quantity * (mark - average_price);
+        }
+
+        double marketValue(double mark) const {
+            return quantity * mark;
+        }
+    };
+
+    explicit PositionBook(size_t capacity)
+        : capacity_(capacity), slots_(std::make_unique<Slot[]>(capacity)) {}
+
+    PositionBook(const PositionBook&) = delete;
+    PositionBook& operator=(const PositionBook&) = delete;
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // Single writer: the FIX thread. side is the FIX side ('1' buy); a
+    // partial fill is just a fill of the executed quantity.
+    void onFill(SymbolId id, char side, double quantity, double price) {
+        if (id >= capacity_ || !(quantity > 0.0)) return;
+        Slot& slot = slots_[id];
+        const double delta = side == '1' ? quantity : -quantity;
+
+        double position = slot.quantity.load(std::memory_order_relaxed);
+        double average = slot.average_price.load(std::memory_order_relaxed);
+        double realized = 0.0;
+        double updated = position + delta;
+
+        if (position == 0.0 || (position > 0.0) == (delta > 0.0)) {
+            average = (std::abs(position) * average + quantity * price) / std::abs(updated);
+        } else {
+            double closed = std::min(quantity, std::abs(position));
+            realized = closed * (price - average) * (position > 0.0 ? 1.0 : -1.0);
+            if (std::abs(updated) < kFlat) {
+                updated = 0.0;
+                average = 0.0;
+            } else if ((updated > 0.0) != (position > 0.0)) {
+                average = price;
+            }
+        }
+
+        uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.quantity.store(updated, std::memory_order_relaxed);
+        slot.average_price.store(average, std::memory_order_relaxed);
+        slot.realized_pnl.store(slot.realized_pnl.load(std::memory_order_relaxed) + realized,
+                                std::memory_order_relaxed);
+        slot.last_fill_price.store(price, std::memory_order_relaxed);
+        slot.fills.store(slot.fills.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        slot.sequence.store(seq + 2, std::memory_order_release);
+
+        if (realized != 0.0) {
+            total_realized_.store(total_realized_.load(std::memory_order_relaxed) + realized,
+                                  std::memory_order_relaxed);
+        }
+    }
+
+    Position read(SymbolId id) const {
+        Position position;
+        if (id >= capacity_) return position;
+        const Slot& slot = slots_[id];
+        uint64_t before, after;
+        do {
+            before = slot.sequence.load(std::memory_order_acquire);
+            position.quantity = slot.quantity.load(std::memory_order_relaxed);
+            position.average_price = slot.average_price.load(std::memory_order_relaxed);
+            position.realized_pnl = slot.realized_pnl.load(std::memory_order_relaxed);
+            position.last_fill_price = slot.last_fill_price.load(std::memory_order_relaxed);
+            position.fills = slot.fills.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = slot.sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        position.version = before / 2;
+        return position;
+    }
+
+    // One field needs no retry loop
+    double quantity(SymbolId id) const {
+        return id < capacity_ ? slots_[id].quantity.load(std::memory_order_acquire) : 0.0;
+    }
+
+    double realizedPnl() const {
+        return total_realized_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr double kFlat = 1e-9;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<double> quantity{0.0};
+        std::atomic<double> average_price{0.0};
+        std::atomic<double> realized_pnl{0.0};
+        std::atomic<double> last_fill_price{0.0};
+        std::atomic<uint64_t> fills{0};
+    };
+
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<double> total_realized_{0.0};
+};
+
+} // namespace quantum_allocation
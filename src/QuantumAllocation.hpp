@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <map>
+#include <complex>
 #include <string>
 #include <memory>
 #include <random>
@@ -21,17 +22,28 @@ namespace quantum_allocation
     class QuantumState
     {
     public:
-        QuantumState(size_t num_assets) : amplitudes(num_assets)
+        QuantumState(size_t num_assets) : amplitudes(num_assets), gen_(std::random_device{}())
+        {
+            reset();
+        }
+
+        // Resize for a new asset count; only grows storage when needed
+        void resize(size_t num_assets)
+        {
+            amplitudes.resize(num_assets);
+            reset();
+        }
+
+        // Redraw random amplitudes in place, reusing storage and the RNG
+        void reset()
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
             std::uniform_real_distribution<> dis(-1.0, 1.0);
 
             // Initialize quantum state with random amplitudes
             double norm = 0.0;
             for (auto &amp : amplitudes)
             {
-                amp = std::complex<double>(dis(gen), dis(gen));
+                amp = std::complex<double>(dis(gen_), dis(gen_));
                 norm += std::norm(amp);
             }
 
@@ -58,6 +70,7 @@ namespace quantum_allocation
 
     private:
         std::vector<std::complex<double>> amplitudes;
+        std::mt19937 gen_;
     };
 
     class QuantumPortfolio
@@ -68,7 +81,10 @@ namespace quantum_allocation
         void addAsset(const std::string &symbol)
         {
             assets_[symbol] = Asset{symbol, 0.0, 0.0, 0.0};
-            quantum_state_ = std::make_unique<QuantumState>(assets_.size());
+            if (quantum_state_)
+                quantum_state_->resize(assets_.size());
+            else
+                quantum_state_ = std::make_unique<QuantumState>(assets_.size());
         }
 
         void updatePrice(const std::string &symbol, double price)
@@ -96,7 +112,9 @@ namespace quantum_allocation
         void updateQuantumState()
         {
             // Implement quantum-inspired state update based on new market data
-            quantum_state_ = std::make_unique<QuantumState>(assets_.size());
+            if (!quantum_state_)
+                return;
+            quantum_state_->reset();
         }
 
         void scheduleMarketDataUpdate()
@@ -111,10 +129,7 @@ namespace quantum_allocation
                         for (auto &[symbol, asset] : assets_)
                         {
                             // Add random price movement for simulation
-                            std::random_device rd;
-                            std::mt19937 gen(rd());
-                            std::normal_distribution<> dis(0, 0.001);
-                            asset.price *= (1.0 + dis(gen));
+                            asset.price *= (1.0 + price_noise_(price_gen_));
                         }
                         updateQuantumState();
                         scheduleMarketDataUpdate();
@@ -124,6 +139,8 @@ namespace quantum_allocation
 
         std::map<std::string, Asset> assets_;
         std::unique_ptr<QuantumState> quantum_state_;
+        std::mt19937 price_gen_{std::random_device{}()};
+        std::normal_distribution<> price_noise_{0, 0.001};
         boost::asio::io_context io_context_;
         boost::asio::deadline_timer market_data_timer_;
     };
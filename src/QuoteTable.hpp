@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace quantum_allocation {
+
+using SymbolId = uint32_t;
+constexpr SymbolId kInvalidSymbol = ~SymbolId(0);
+
+// Maps symbols to dense IDs [0, capacity). Interning takes a mutex and is
+// meant for subscribe time; lookup is lock-free and allocation-free, so the
+// feed thread can resolve every tick without contending with subscribers.
+// IDs are never reused or removed.
+class SymbolTable {
+public:
+    explicit SymbolTable(size_t capacity)
+        : capacity_(capacity), mask_(bucketCount(capacity) - 1),
+          buckets_(std::make_unique<Bucket[]>(mask_ + 1)),
+          names_(std::make_unique<std::string[]>(capacity)) {}
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    SymbolId intern(std::string_view symbol) {
+        SymbolId id = tryIntern(symbol);
+        if (id == kInvalidSymbol) {
+            throw std::length_error("SymbolTable full, cannot intern " + std::string(symbol));
+        }
+        return id;
+    }
+
+    // As intern, but returns kInvalidSymbol instead of throwing when full
+    SymbolId tryIntern(std::string_view symbol) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SymbolId id = find(symbol);
+        if (id != kInvalidSymbol) return id;
+
+        size_t count = size_.load(std::memory_order_relaxed);
+        if (count == capacity_) return kInvalidSymbol;
+        id = static_cast<SymbolId>(count);
+        names_[id] = std::string(symbol);
+
+        size_t b = hash(symbol) & mask_;
+        while (buckets_[b].id.load(std::memory_order_relaxed) != kInvalidSymbol) {
+            b = (b + 1) & mask_;
+        }
+        // Publishes the name written above to lock-free readers
+        buckets_[b].id.store(id, std::memory_order_release);
+        size_.store(count + 1, std::memory_order_release);
+        return id;
+    }
+
+    SymbolId find(std::string_view symbol) const {
+        for (size_t b = hash(symbol) & mask_;; b = (b + 1) & mask_) {
+            SymbolId id = buckets_[b].id.load(std::memory_order_acquire);
+            if (id == kInvalidSymbol) return kInvalidSymbol;
+            if (names_[id] == symbol) return id;
+        }
+    }
+
+    const std::string& name(SymbolId id) const {
+        return names_[id];
+    }
+
+    size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Bucket {
+        std::atomic<SymbolId> id{kInvalidSymbol};
+    };
+
+    // At most half full, so probes stay short and always hit an empty bucket
+    static size_t bucketCount(size_t capacity) {
+        size_t n = 16;
+        while (n < 2 * capacity) n <<= 1;
+        return n;
+    }
+
+    static size_t hash(std::string_view symbol) {
+        return std::hash<std::string_view>()(symbol);
+    }
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Bucket[]> buckets_;
+    std::unique_ptr<std::string[]> names_;
+    std::atomic<size_t> size_{0};
+    std::mutex mutex_;
+};
+
+// Latest top-of-book per symbol ID. Each slot is a seqlock on its own cache
+// line: the single feed writer bumps the sequence to odd, stores the fields
+// and bumps it back to even, and readers retry if the sequence moved under
+// them. Readers never block the writer and the writer never allocates.
+// version counts updates, so a consumer that remembers it can tell whether a
+// quote is new without comparing timestamps.
+class QuoteTable {
+public:
+    struct Quote {
+        double price = 0.0;
+        double volume = 0.0;
+        double bid = 0.0;
+        double ask = 0.0;
+        std::chrono::system_clock::time_point timestamp;
+        uint64_t version = 0;  // 0 = never updated
+    };
+
+    explicit QuoteTable(size_t capacity)
+        : capacity_(capacity), slots_(std::make_unique<Slot[]>(capacity)) {}
+
+    QuoteTable(const QuoteTable&) = delete;
+    QuoteTable& operator=(const QuoteTable&) = delete;
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // Single writer per slot; IDs past capacity (e.g. kInvalidSymbol) are ignored
+    void update(SymbolId id, double price, double volume, double bid, double ask,
+                std::chrono::system_clock::time_point timestamp) {
+        if (id >= capacity_) return;
+        Slot& slot = slots_[id];
+        uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.price.store(price, std::memory_order_relaxed);
+        slot.volume.store(volume, std::memory_order_relaxed);
+        slot.bid.store(bid, std::memory_order_relaxed);
+        slot.ask.store(ask, std::memory_order_relaxed);
+        slot.timestamp.store(timestamp.time_since_epoch().count(), std::memory_order_relaxed);
+
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // An empty quote (version 0) for IDs past capacity
+    Quote read(SymbolId id) const {
+        if (id >= capacity_) return Quote{};
+        const Slot& slot = slots_[id];
+        Quote quote;
+        uint64_t before, after;
+        do {
+            before = slot.sequence.load(std::memory_order_acquire);
+            quote.price = slot.price.load(std::memory_order_relaxed);
+            quote.volume = slot.volume.load(std::memory_order_relaxed);
+            quote.bid = slot.bid.load(std::memory_order_relaxed);
+            quote.ask = slot.ask.load(std::memory_order_relaxed);
+            quote.timestamp = std::chrono::system_clock::time_point(
+                std::chrono::system_clock::duration(slot.timestamp.load(std::memory_order_relaxed)));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = slot.sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        quote.version = before / 2;
+        return quote;
+    }
+
+    // Cheap staleness check: no field reads, no retry loop
+    uint64_t version(SymbolId id) const {
+        if (id >= capacity_) return 0;
+        return slots_[id].sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<double> price{0.0};
+        std::atomic<double> volume{0.0};
+        std::atomic<double> bid{0.0};
+        std::atomic<double> ask{0.0};
+        std::atomic<std::chrono::system_clock::rep> timestamp{0};
+    };
+
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+} // namespace quantum_allocation
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace quantum_allocation {
+
+// Log2-bucketed latency histogram in microseconds; recording is a single
+// relaxed increment so it can sit on the trading path.
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = 40;
+
+    void record(std::chrono::nanoseconds latency) {
+        uint64_t us = static_cast<uint64_t>(std::max<int64_t>(0, latency.count() / 1000));
+        size_t bucket = 0;
+        while (bucket + 1 < kBuckets && (uint64_t(1) << bucket) <= us) ++bucket;
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_us_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t max = max_us_.load(std::memory_order_relaxed);
+        while (us > max && !max_us_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    double meanUs() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(total_us_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    uint64_t maxUs() const {
+        return max_us_.load(std::memory_order_relaxed);
+    }
+
+    // Upper bound of the bucket holding quantile q, in microseconds
+    uint64_t percentileUs(double q) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(q * (n - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            seen += buckets_[b].load(std::memory_order_relaxed);
+            if (seen >= target) return uint64_t(1) << b;
+        }
+        return maxUs();
+    }
+
+    std::string summary() const {
+        return "n=" + std::to_string(count()) +
+               " p50<=" + std::to_string(percentileUs(0.50)) + "us" +
+               " p90<=" + std::to_string(percentileUs(0.90)) + "us" +
+               " p99<=" + std::to_string(percentileUs(0.99)) + "us" +
+               " max=" + std::to_string(maxUs()) + "us";
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+// Runs rebalance cycles when the data calls for one instead of on a fixed
+// sleep. Triggers are polled on a strand of the application's io_context;
+// any that fire, or the max_interval timer, mark a cycle pending. Pending
+// requests coalesce: at most one cycle starts per min_interval and none
+// starts while the previous compute stage is still running.
+//
+// A cycle is two stages on two single-thread executors: compute (market
+// data, optimize, risk) and execute (strategy hooks, orders). The next
+// cycle's compute may overlap the previous cycle's execute; executes stay
+// in order. Latency from the newest market event at trigger time to the
+// end of execute goes into a histogram.
+template <typename Plan>
+class RebalanceScheduler {
+public:
+    struct Settings {
+        std::chrono::milliseconds poll_interval{50};
+        std::chrono::milliseconds min_interval{1000};
+        std::chrono::milliseconds max_interval{300000};
+    };
+
+    struct Cycle {
+        uint64_t id = 0;
+        std::string reasons;  // Comma-separated names of the triggers that fired
+        std::chrono::system_clock::time_point event_time;
+    };
+
+    // check() runs on the scheduler strand; rebase() runs there too when a
+    // cycle launches, so a trigger measures change since the last cycle
+    struct Trigger {
+        std::string name;
+        std::function<bool()> check;
+        std::function<void()> rebase;
+    };
+
+    // compute returns false to skip execute (e.g. not enough data yet)
+    using ComputeStage = std::function<bool(const Cycle&, Plan&)>;
+    using ExecuteStage = std::function<void(const Cycle&, Plan&)>;
+    using EventClock = std::function<std::chrono::system_clock::time_point()>;
+
+    RebalanceScheduler(boost::asio::io_context& ioc, const Settings& settings)
+        : ioc_(ioc), settings_(settings), strand_(boost::asio::make_strand(ioc)), timer_(strand_),
+          compute_pool_(1), execute_pool_(1) {}
+
+    ~RebalanceScheduler() {
+        stop();
+    }
+
+    RebalanceScheduler(const RebalanceScheduler&) = delete;
+    RebalanceScheduler& operator=(const RebalanceScheduler&) = delete;
+
+    void addTrigger(Trigger trigger) {
+        triggers_.push_back(std::move(trigger));
+    }
+
+    // Newest market data timestamp, the start point for latency
+    void setEventClock(EventClock clock) {
+        event_clock_ = std::move(clock);
+    }
+
+    void start(ComputeStage compute, ExecuteStage execute) {
+        compute_ = std::move(compute);
+        execute_ = std::move(execute);
+        running_.store(true, std::memory_order_release);
+        // The first cycle runs as soon as the first poll sees data
+        last_launch_ = std::chrono::steady_clock::now() - settings_.max_interval;
+        boost::asio::post(strand_, [this] { poll(); });
+    }
+
+    // Waits for in-flight stages and for the strand to drain; no new cycle
+    // starts afterwards. If the io_context has been stopped its threads must
+    // be joined before the scheduler is destroyed.
+    void stop() {
+        if (!running_.exchange(false)) return;
+        compute_pool_.join();
+        execute_pool_.join();
+
+        std::promise<void> drained;
+        auto done = drained.get_future();
+        boost::asio::post(strand_, [this, &drained] {
+            timer_.cancel();
+            drained.set_value();
+        });
+        while (done.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+            if (ioc_.stopped()) break;
+        }
+    }
+
+    const LatencyHistogram& latency() const {
+        return latency_;
+    }
+
+    uint64_t cyclesRun() const {
+        return cycles_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t triggersCoalesced() const {
+        return coalesced_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void poll() {
+        if (!running_.load(std::memory_order_acquire)) return;
+        auto now = std::chrono::steady_clock::now();
+
+        std::string reasons;
+        for (auto& trigger : triggers_) {
+            if (trigger.check()) {
+                reasons += reasons.empty() ? trigger.name : "," + trigger.name;
+            }
+        }
+        if (now - last_launch_ >= settings_.max_interval) {
+            reasons += reasons.empty() ? "timer" : ",timer";
+        }
+
+        if (!reasons.empty()) {
+            if (pending_) {
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                pending_ = true;
+                pending_cycle_.reasons.clear();
+                pending_cycle_.event_time = event_clock_ ? event_clock_()
+                                                         : std::chrono::system_clock::now();
+            }
+            if (pending_cycle_.reasons.find(reasons) == std::string::npos) {
+                pending_cycle_.reasons += pending_cycle_.reasons.empty() ? reasons : "," + reasons;
+            }
+        }
+        tryLaunch(now);
+
+        timer_.expires_after(settings_.poll_interval);
+        timer_.async_wait([this](boost::system::error_code ec) {
+            if (!ec) poll();
+        });
+    }
+
+    void tryLaunch(std::chrono::steady_clock::time_point now) {
+        if (!pending_ || computing_ || now - last_launch_ < settings_.min_interval) return;
+        pending_ = false;
+        computing_ = true;
+        last_launch_ = now;
+        for (auto& trigger : triggers_) {
+            if (trigger.rebase) trigger.rebase();
+        }
+
+        auto cycle = std::make_shared<Cycle>(pending_cycle_);
+        cycle->id = ++next_cycle_id_;
+        boost::asio::post(compute_pool_, [this, cycle] { runCompute(cycle); });
+    }
+
+    void runCompute(std::shared_ptr<Cycle> cycle) {
+        auto plan = std::make_shared<Plan>();
+        bool ready = false;
+        try {
+            ready = compute_(*cycle, *plan);
+        } catch (const std::exception& e) {
+            std::cerr << "Rebalance " << cycle->id << " compute failed: " << e.what() << std::endl;
+        }
+        if (ready && running_.load(std::memory_order_acquire)) {
+            boost::asio::post(execute_pool_, [this, cycle, plan] { runExecute(cycle, plan); });
+        }
+        // Hand the compute slot back; a trigger that fired meanwhile launches now
+        boost::asio::post(strand_, [this] {
+            computing_ = false;
+            if (running_.load(std::memory_order_acquire)) tryLaunch(std::chrono::steady_clock::now());
+        });
+    }
+
+    void runExecute(std::shared_ptr<Cycle> cycle, std::shared_ptr<Plan> plan) {
+        try {
+            execute_(*cycle, *plan);
+            latency_.record(std::chrono::system_clock::now() - cycle->event_time);
+            cycles_.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            std::cerr << "Rebalance " << cycle->id << " execute failed: " << e.what() << std::endl;
+        }
+    }
+
+    boost::asio::io_context& ioc_;
+    Settings settings_;
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    boost::asio::steady_timer timer_;
+    boost::asio::thread_pool compute_pool_;
+    boost::asio::thread_pool execute_pool_;
+
+    std::vector<Trigger> triggers_;
+    EventClock event_clock_;
+    ComputeStage compute_;
+    ExecuteStage execute_;
+
+    // Strand-only state
+    bool pending_ = false;
+    bool computing_ = false;
+    Cycle pending_cycle_;
+    uint64_t next_cycle_id_ = 0;
+    std::chrono::steady_clock::time_point last_launch_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> cycles_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    LatencyHistogram latency_;
+};
+
+} // namespace quantum_allocation
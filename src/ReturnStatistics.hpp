@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "StateVectorKernels.hpp"
+
+namespace quantum_allocation {
+
+// Streaming mean and covariance of per-bar asset returns. Two estimators
+// are kept side by side:
+//   - a sliding window of the last `window` bars, updated with Welford's
+//     add/remove recurrences in O(n^2) per bar instead of rescanning the
+//     window; it is rebuilt from the ring once per window to shed drift
+//   - an exponentially weighted estimate with decay lambda (RiskMetrics
+//     style; 0 disables it)
+// Covariances are stored as packed upper triangles, row i holding columns
+// i..n-1 contiguously, so each update row is a unit-stride multiply-add.
+class ReturnStatistics {
+public:
+    ReturnStatistics(size_t num_assets, size_t window, double ewma_lambda = 0.0)
+        : n_(num_assets), window_(std::max<size_t>(2, window)), lambda_(ewma_lambda),
+          ring_(window_ * num_assets), prices_(num_assets), current_(num_assets),
+          delta_(num_assets), residual_(num_assets), mean_(num_assets), comoment_(packedSize(num_assets)),
+          ewma_mean_(num_assets), ewma_cov_(packedSize(num_assets)) {}
+
+    static size_t packedSize(size_t n) {
+        return n * (n + 1) / 2;
+    }
+
+    // Base of row i in a packed upper triangle: base[j] is element (i, j), j >= i
+    size_t rowOffset(size_t i) const {
+        return i * n_ - i * (i - 1) / 2 - i;
+    }
+
+    // Feeds one bar of prices. The first bar, and any bar with a
+    // non-positive price, only sets the reference prices for the next one.
+    // Returns true when a return observation was added.
+    bool addPrices(const double* prices) {
+        bool valid = has_prices_;
+        for (size_t i = 0; i < n_; ++i) {
+            if (prices[i] <= 0.0) valid = false;
+        }
+        if (valid) {
+            for (size_t i = 0; i < n_; ++i) {
+                current_[i] = prices[i] / prices_[i] - 1.0;
+            }
+            addReturns(current_.data());
+        }
+        has_prices_ = true;
+        for (size_t i = 0; i < n_; ++i) {
+            if (prices[i] > 0.0) prices_[i] = prices[i];
+        }
+        return valid;
+    }
+
+    void addReturns(const double* returns) {
+        double* slot = ring_.data() + head_ * n_;
+        if (count_ == window_) {
+            remove(slot);
+        }
+        std::copy(returns, returns + n_, slot);
+        add(slot);
+        head_ = (head_ + 1) % window_;
+        ++bars_;
+
+        if (lambda_ > 0.0) {
+            addEwma(returns);
+        }
+        if (count_ == window_ && bars_ % window_ == 0) {
+            rebuild();
+        }
+    }
+
+    size_t numAssets() const { return n_; }
+    size_t window() const { return window_; }
+    size_t count() const { return count_; }
+    size_t bars() const { return bars_; }
+    bool ready() const { return count_ >= 2; }
+
+    const double* mean() const { return mean_.data(); }
+    const double* ewmaMean() const { return ewma_mean_.data(); }
+
+    // Unbiased sample covariance over the window, packed
+    void packedCovariance(double* out) const {
+        double scale = count_ > 1 ? 1.0 / (count_ - 1) : 0.0;
+        for (size_t k = 0; k < comoment_.size(); ++k) {
+            out[k] = comoment_[k] * scale;
+        }
+    }
+
+    const double* packedEwmaCovariance() const {
+        return ewma_cov_.data();
+    }
+
+    // Dense copies in the shape the optimizers take
+    void meanReturns(std::vector<double>& out, bool ewma = false) const {
+        const double* source = ewma ? ewma_mean_.data() : mean_.data();
+        out.assign(source, source + n_);
+    }
+
+    void covariance(std::vector<std::vector<double>>& out, bool ewma = false) const {
+        double scale = ewma ? 1.0 : (count_ > 1 ? 1.0 / (count_ - 1) : 0.0);
+        const double* packed = ewma ? ewma_cov_.data() : comoment_.data();
+        out.resize(n_);
+        for (auto& row : out) {
+            row.resize(n_);
+        }
+        for (size_t i = 0; i < n_; ++i) {
+            const double* row = packed + rowOffset(i);
+            for (size_t j = i; j < n_; ++j) {
+                double c = row[j] * scale;
+                out[i][j] = c;
+                out[j][i] = c;
+            }
+        }
+    }
+
+    // Most recent return bar; only meaningful once count() > 0
+    const double* latestReturns() const {
+        return ring_.data() + ((head_ + window_ - 1) % window_) * n_;
+    }
+
+    // Bars in the window, oldest first, row-major (count() x numAssets())
+    void windowReturns(std::vector<double>& out) const {
+        out.resize(count_ * n_);
+        size_t oldest = (head_ + window_ - count_) % window_;
+        for (size_t b = 0; b < count_; ++b) {
+            const double* bar = ring_.data() + ((oldest + b) % window_) * n_;
+            std::copy(bar, bar + n_, out.begin() + b * n_);
+        }
+    }
+
+private:
+    // Welford: mean += d / k, M_ij += d_i * (x_j - mean_j)
+    void add(const double* x) {
+        ++count_;
+        double inv = 1.0 / count_;
+        for (size_t i = 0; i < n_; ++i) {
+            delta_[i] = x[i] - mean_[i];
+            mean_[i] += delta_[i] * inv;
+        }
+        updateComoment(x, 1.0);
+    }
+
+    // Inverse recurrence: mean -= d / (k - 1), M_ij -= d_i * (x_j - mean_j)
+    void remove(const double* x) {
+        --count_;
+        if (count_ == 0) {
+            std::fill(mean_.begin(), mean_.end(), 0.0);
+            std::fill(comoment_.begin(), comoment_.end(), 0.0);
+            return;
+        }
+        double inv = 1.0 / count_;
+        for (size_t i = 0; i < n_; ++i) {
+            delta_[i] = x[i] - mean_[i];
+            mean_[i] -= delta_[i] * inv;
+        }
+        updateComoment(x, -1.0);
+    }
+
+    void updateComoment(const double* x, double sign) {
+        // Residuals against the updated mean, so the inner loop reads one stream
+        double* e = residual_.data();
+        for (size_t j = 0; j < n_; ++j) {
+            e[j] = x[j] - mean_[j];
+        }
+        double* m = comoment_.data();
+        for (size_t i = 0; i < n_; ++i) {
+            double d = sign * delta_[i];
+            double* row = m + rowOffset(i);
+            for (size_t j = i; j < n_; ++j) {
+                row[j] += d * e[j];
+            }
+        }
+    }
+
+    // West's weighted recurrence with weight a = 1 - lambda:
+    // mean += a d, C = lambda (C + a d d')
+    void addEwma(const double* x) {
+        double a = 1.0 - lambda_;
+        if (bars_ == 1) {
+            std::copy(x, x + n_, ewma_mean_.begin());
+            return;
+        }
+        for (size_t i = 0; i < n_; ++i) {
+            delta_[i] = x[i] - ewma_mean_[i];
+            ewma_mean_[i] += a * delta_[i];
+        }
+        const double* e = delta_.data();
+        const double lambda = lambda_;
+        double* c = ewma_cov_.data();
+        for (size_t i = 0; i < n_; ++i) {
+            double d = a * e[i];
+            double* row = c + rowOffset(i);
+            for (size_t j = i; j < n_; ++j) {
+                row[j] = lambda * (row[j] + d * e[j]);
+            }
+        }
+    }
+
+    // Recomputes the window estimate from the ring with the forward
+    // recurrence, discarding rounding accumulated by add/remove pairs
+    void rebuild() {
+        size_t bars = count_;
+        count_ = 0;
+        std::fill(mean_.begin(), mean_.end(), 0.0);
+        std::fill(comoment_.begin(), comoment_.end(), 0.0);
+        size_t oldest = (head_ + window_ - bars) % window_;
+        for (size_t b = 0; b < bars; ++b) {
+            add(ring_.data() + ((oldest + b) % window_) * n_);
+        }
+    }
+
+    size_t n_;
+    size_t window_;
+    double lambda_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t bars_ = 0;
+    bool has_prices_ = false;
+
+    kernels::AlignedVector<double> ring_;
+    std::vector<double> prices_;
+    std::vector<double> current_;
+    kernels::AlignedVector<double> delta_;
+    kernels::AlignedVector<double> residual_;
+    kernels::AlignedVector<double> mean_;
+    kernels::AlignedVector<double> comoment_;
+    kernels::AlignedVector<double> ewma_mean_;
+    kernels::AlignedVector<double> ewma_cov_;
+};
+
+} // namespace quantum_allocation
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "QuoteTable.hpp"
+
+namespace quantum_allocation {
+
+// Pre-trade limits, as fractions of capital like the config file states them;
+// 0 disables a limit
+struct RiskLimits {
+    double capital = 0.0;             // Account value the fractions refer to
+    double max_position = 0.0;        // |position| * price per symbol
+    double max_daily_turnover = 0.0;  // Notional sent today, less cancels
+    double max_leverage = 0.0;        // Gross exposure after the order
+    double stop_loss = 0.0;           // Daily loss that halts risk-increasing orders
+};
+
+enum class RiskCheck : uint8_t {
+    Accepted,
+    Position,
+    Turnover,
+    Leverage,
+    StopLoss,
+    Invalid,
+};
+
+inline const char* riskCheckName(RiskCheck check) {
+    switch (check) {
+    case RiskCheck::Accepted: return "accepted";
+    case RiskCheck::Position: return "max_position";
+    case RiskCheck::Turnover: return "max_daily_turnover";
+    case RiskCheck::Leverage: return "max_leverage";
+    case RiskCheck::StopLoss: return "stop_loss";
+    case RiskCheck::Invalid:  return "invalid_order";
+    }
+    return "unknown";
+}
+
+// Per-order limit checks on the order path. Counters live in per-symbol
+// slots indexed by SymbolId, each on its own cache line, plus a few global
+// totals; a check reads a handful of atomics and reserves the order's
+// quantity and notional with relaxed adds, so it takes no lock and never
+// allocates.
+//
+// Orders are checked from one thread (the execute stage). Fills, cancels and
+// rejects arrive from the FIX thread and release what the order reserved, so
+// counters touched by both sides use atomic read-modify-write. Open orders
+// count against the position limit on the side they would move it, and
+// the gross they would add is reserved against the leverage limit, so a
+// burst of orders cannot slip past a limit before any of them fills.
+class PreTradeRiskGate {
+public:
+    explicit PreTradeRiskGate(size_t capacity, const RiskLimits& limits = {})
+        : capacity_(capacity), slots_(std::make_unique<Slot[]>(capacity)) {
+        setLimits(limits);
+    }
+
+    PreTradeRiskGate(const PreTradeRiskGate&) = delete;
+    PreTradeRiskGate& operator=(const PreTradeRiskGate&) = delete;
+
+    // Limits are converted to absolute notionals once, off the order path
+    void setLimits(const RiskLimits& limits) {
+        auto absolute = [&](double fraction) {
+            return fraction > 0.0 ? fraction * limits.capital : kUnlimited;
+        };
+        max_position_.store(absolute(limits.max_position), std::memory_order_relaxed);
+        max_turnover_.store(absolute(limits.max_daily_turnover), std::memory_order_relaxed);
+        max_gross_.store(absolute(limits.max_leverage), std::memory_order_relaxed);
+        max_loss_.store(absolute(limits.stop_loss), std::memory_order_relaxed);
+    }
+
+    // side is the FIX side: '1' buy, '2' sell. Must only be called from one
+    // thread: limits are tested against counters loaded before this order's
+    // reservation is added, so two concurrent checks could both pass.
+    RiskCheck check(SymbolId id, char side, double quantity, double price) {
+        if (id >= capacity_ || !(quantity > 0.0) || !(price > 0.0)) return RiskCheck::Invalid;
+        Slot& slot = slots_[id];
+        const double sign = side == '1' ? 1.0 : -1.0;
+        const double notional = quantity * price;
+
+        double position = slot.position.load(std::memory_order_relaxed);
+        double open = (sign > 0 ? slot.open_buy : slot.open_sell).load(std::memory_order_relaxed);
+        double projected = position + sign * (open + quantity);
+        bool increases = std::abs(projected) > std::abs(position);
+        // Gross this order adds on top of the symbol's other open orders
+        double added = std::max(0.0, std::abs(projected) - std::abs(position + sign * open)) * price;
+
+        if (increases) {
+            if (halted_.load(std::memory_order_relaxed)) return RiskCheck::StopLoss;
+            if (std::abs(projected) * price > max_position_.load(std::memory_order_relaxed)) {
+                return RiskCheck::Position;
+            }
+            // Open orders on every symbol count, not just filled positions
+            if (gross_.load(std::memory_order_relaxed) + reserved_gross_.load(std::memory_order_relaxed) +
+                    added > max_gross_.load(std::memory_order_relaxed)) {
+                return RiskCheck::Leverage;
+            }
+        }
+        if (turnover_.load(std::memory_order_relaxed) + notional >
+            max_turnover_.load(std::memory_order_relaxed)) {
+            return RiskCheck::Turnover;
+        }
+
+        add(sign > 0 ? slot.open_buy : slot.open_sell, quantity);
+        if (added > 0.0) {
+            add(sign > 0 ? slot.reserved_buy : slot.reserved_sell, added);
+            add(reserved_gross_, added);
+        }
+        add(turnover_, notional);
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+        return RiskCheck::Accepted;
+    }
+
+    // Cancelled, expired or rejected remainder of an accepted order, or one
+    // that never reached the market
+    void release(SymbolId id, char side, double quantity, double price) {
+        if (id >= capacity_) return;
+        Slot& slot = slots_[id];
+        unreserve(slot, side, quantity);
+        add(turnover_, -quantity * price);
+    }
+
+    // Moves filled quantity from open to position and re-marks the symbol
+    void onFill(SymbolId id, char side, double quantity, double price) {
+        if (id >= capacity_) return;
+        Slot& slot = slots_[id];
+        const double sign = side == '1' ? 1.0 : -1.0;
+        unreserve(slot, side, quantity);
+
+        SlotWriter writer(slot);
+        double before = slot.position.load(std::memory_order_relaxed);
+        double after = before + sign * quantity;
+        double mark = slot.mark.load(std::memory_order_relaxed);
+        slot.position.store(after, std::memory_order_relaxed);
+        slot.mark.store(price, std::memory_order_relaxed);
+        add(gross_, std::abs(after) * price - std::abs(before) * mark);
+        add(value_, after * price - before * mark);
+        add(cash_, -sign * quantity * price);
+    }
+
+    // Re-marks a position off the order path (e.g. on rebalance), keeping
+    // gross exposure and the stop-loss P&L current between fills
+    void mark(SymbolId id, double price) {
+        if (id >= capacity_ || !(price > 0.0)) return;
+        Slot& slot = slots_[id];
+        SlotWriter writer(slot);
+        double position = slot.position.load(std::memory_order_relaxed);
+        double previous = slot.mark.load(std::memory_order_relaxed);
+        slot.mark.store(price, std::memory_order_relaxed);
+        add(gross_, std::abs(position) * (price - previous));
+        add(value_, position * (price - previous));
+    }
+
+    // Daily P&L = cash flow from fills + change in marked value; halts
+    // risk-increasing orders once it falls below -stop_loss * capital.
+    // Call after marking; O(1).
+    bool updateStopLoss() {
+        double pnl = dailyPnl();
+        bool halt = pnl < -max_loss_.load(std::memory_order_relaxed);
+        halted_.store(halt, std::memory_order_relaxed);
+        return halt;
+    }
+
+    // Starts a new trading day: turnover and P&L restart, positions carry
+    void resetDay() {
+        turnover_.store(0.0, std::memory_order_relaxed);
+        day_start_.store(cash_.load(std::memory_order_relaxed) + marketValue(),
+                         std::memory_order_relaxed);
+        halted_.store(false, std::memory_order_relaxed);
+    }
+
+    double position(SymbolId id) const {
+        return id < capacity_ ? slots_[id].position.load(std::memory_order_relaxed) : 0.0;
+    }
+
+    double grossExposure() const { return gross_.load(std::memory_order_relaxed); }
+    double reservedGross() const { return reserved_gross_.load(std::memory_order_relaxed); }
+    double turnover() const { return turnover_.load(std::memory_order_relaxed); }
+    bool halted() const { return halted_.load(std::memory_order_relaxed); }
+    uint64_t accepted() const { return accepted_.load(std::memory_order_relaxed); }
+
+    double dailyPnl() const {
+        return cash_.load(std::memory_order_relaxed) + marketValue() -
+               day_start_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr double kUnlimited = 1e300;
+
+    struct alignas(64) Slot {
+        std::atomic<double> position{0.0};  // Filled, signed
+        std::atomic<double> open_buy{0.0};  // Accepted, not yet filled or released
+        std::atomic<double> open_sell{0.0};
+        std::atomic<double> reserved_buy{0.0};  // Gross the open orders would add
+        std::atomic<double> reserved_sell{0.0};
+        std::atomic<double> mark{0.0};      // Last fill or mark price
+        std::atomic<bool> writing{false};   // Serializes onFill and mark, never check
+    };
+
+    // Fills (FIX thread) and marks (execute stage) both move position, mark
+    // and the totals derived from them; a short spin keeps each update whole
+    struct SlotWriter {
+        explicit SlotWriter(Slot& slot) : slot_(slot) {
+            while (slot_.writing.exchange(true, std::memory_order_acquire)) {
+            }
+        }
+        ~SlotWriter() {
+            slot_.writing.store(false, std::memory_order_release);
+        }
+        Slot& slot_;
+    };
+
+    // C++17 has no fetch_add for atomic<double>; returns the previous value
+    static double add(std::atomic<double>& target, double delta) {
+        double current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+        }
+        return current;
+    }
+
+    // Takes filled or released quantity off a side's open orders, with the
+    // matching share of the gross they reserved
+    void unreserve(Slot& slot, char side, double quantity) {
+        const bool buy = side == '1';
+        double open = add(buy ? slot.open_buy : slot.open_sell, -quantity);
+        if (!(open > 0.0)) return;
+        double share = std::min(1.0, quantity / open);
+        std::atomic<double>& reserved = buy ? slot.reserved_buy : slot.reserved_sell;
+        double current = reserved.load(std::memory_order_relaxed);
+        while (!reserved.compare_exchange_weak(current, current * (1.0 - share),
+                                               std::memory_order_relaxed)) {
+        }
+        add(reserved_gross_, -current * share);
+    }
+
+    // Sum of position * mark, kept incrementally: fills change it by the
+    // trade, marks by the price move
+    double marketValue() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<double> gross_{0.0};
+    std::atomic<double> reserved_gross_{0.0};  // Gross open orders would add once filled
+    std::atomic<double> turnover_{0.0};
+    std::atomic<double> cash_{0.0};
+    std::atomic<double> value_{0.0};
+    std::atomic<double> day_start_{0.0};
+    std::atomic<bool> halted_{false};
+    std::atomic<uint64_t> accepted_{0};
+
+    alignas(64) std::atomic<double> max_position_{kUnlimited};
+    std::atomic<double> max_turnover_{kUnlimited};
+    std::atomic<double> max_gross_{kUnlimited};
+    std::atomic<double> max_loss_{kUnlimited};
+};
+
+} // namespace quantum_allocation
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace quantum_allocation {
+
+class StateBufferPool;
+
+// Move-only handle to a pooled, 64-byte aligned array of T. Contents are
+// uninitialized on acquire; the memory goes back to its pool on destruction.
+template <typename T = double>
+class StateBuffer {
+public:
+    StateBuffer() = default;
+    StateBuffer(const StateBuffer&) = delete;
+    StateBuffer& operator=(const StateBuffer&) = delete;
+
+    StateBuffer(StateBuffer&& other) noexcept { swap(other); }
+    StateBuffer& operator=(StateBuffer&& other) noexcept {
+        StateBuffer(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~StateBuffer();
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+    void swap(StateBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(size_class_, other.size_class_);
+        std::swap(pool_, other.pool_);
+    }
+
+private:
+    friend class StateBufferPool;
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t size_class_ = 0;
+    StateBufferPool* pool_ = nullptr;
+};
+
+// Recycles state-vector memory by power-of-two size class, so repeated
+// optimizations reuse the same blocks instead of going back to the heap.
+// Blocks of 2 MiB and up are mapped directly and advised for transparent
+// huge pages where the platform supports it.
+class StateBufferPool {
+public:
+    static constexpr size_t kAlignment = 64;
+    static constexpr size_t kMinClass = 12;        // 4 KiB
+    static constexpr size_t kHugePageClass = 21;   // 2 MiB
+
+    StateBufferPool() = default;
+    StateBufferPool(const StateBufferPool&) = delete;
+    StateBufferPool& operator=(const StateBufferPool&) = delete;
+
+    ~StateBufferPool() {
+        trim();
+    }
+
+    // Process-wide pool used by circuits that are not given one
+    static StateBufferPool& instance() {
+        static StateBufferPool pool;
+        return pool;
+    }
+
+    template <typename T = double>
+    StateBuffer<T> acquire(size_t count) {
+        size_t size_class = classFor(count * sizeof(T));
+        void* block = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_class < free_.size() && !free_[size_class].empty()) {
+                block = free_[size_class].back();
+                free_[size_class].pop_back();
+            }
+        }
+        if (!block) {
+            block = allocate(size_class);
+        }
+
+        StateBuffer<T> buffer;
+        buffer.data_ = static_cast<T*>(block);
+        buffer.size_ = count;
+        buffer.size_class_ = size_class;
+        buffer.pool_ = this;
+        return buffer;
+    }
+
+    // Return every idle block to the system
+    void trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t c = 0; c < free_.size(); ++c) {
+            for (void* block : free_[c]) {
+                deallocate(block, c);
+            }
+            free_[c].clear();
+        }
+    }
+
+private:
+    template <typename T>
+    friend class StateBuffer;
+
+    void release(void* block, size_t size_class) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() <= size_class) free_.resize(size_class + 1);
+        free_[size_class].push_back(block);
+    }
+
+    static size_t classFor(size_t bytes) {
+        size_t size_class = kMinClass;
+        while ((size_t(1) << size_class) < bytes) ++size_class;
+        return size_class;
+    }
+
+    static void* allocate(size_t size_class) {
+        size_t bytes = size_t(1) << size_class;
+#ifdef __linux__
+        if (size_class >= kHugePageClass) {
+            // mmap only aligns to 4 KiB; map a huge page extra and unmap the
+            // ends so the block starts on a 2 MiB frame THP can back
+            const size_t huge = size_t(1) << kHugePageClass;
+            void* mapped = mmap(nullptr, bytes + huge, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapped == MAP_FAILED) throw std::bad_alloc();
+            char* base = static_cast<char*>(mapped);
+            char* p = reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(base) + huge - 1) & ~(uintptr_t(huge) - 1));
+            if (p > base) munmap(base, p - base);
+            if (p + bytes < base + bytes + huge) munmap(p + bytes, base + huge - p);
+#ifdef MADV_HUGEPAGE
+            madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+            return p;
+        }
+#endif
+        void* p = std::aligned_alloc(kAlignment, bytes);
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+
+    static void deallocate(void* block, size_t size_class) {
+#ifdef __linux__
+        if (size_class >= kHugePageClass) {
+            munmap(block, size_t(1) << size_class);
+            return;
+        }
+#endif
+        std::free(block);
+    }
+
+    std::mutex mutex_;
+    std::vector<std::vector<void*>> free_;
+};
+
+template <typename T>
+inline StateBuffer<T>::~StateBuffer() {
+    if (pool_) pool_->release(data_, size_class_);
+}
+
+} // namespace quantum_allocation
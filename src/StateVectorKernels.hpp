@@ -0,0 +1,499 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define QUARTZ_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace quantum_allocation {
+namespace kernels {
+
+// Amplitudes are stored as split real/imaginary arrays. Every kernel works on
+// a range [begin, end) of a compressed index space that skips the bits fixed
+// by the gate, so only affected amplitudes are visited and ranges can be
+// handed out to different workers.
+
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void* p = std::aligned_alloc(Alignment, bytes);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) { std::free(p); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+template <typename Real>
+using AlignedVector = std::vector<Real, AlignedAllocator<Real>>;
+
+// Number of indices left once the bits of mask are fixed
+inline size_t compressedSize(size_t size, size_t mask) {
+    for (size_t m = mask; m; m &= m - 1) size >>= 1;
+    return size;
+}
+
+// Insert a zero bit below every set bit of mask (lowest first)
+inline size_t depositZeros(size_t k, size_t mask) {
+    for (size_t m = mask; m; m &= m - 1) {
+        size_t low = (m & (~m + 1)) - 1;
+        k = ((k & ~low) << 1) | (k & low);
+    }
+    return k;
+}
+
+// Kernel table for one storage precision (float or double)
+template <typename Real>
+struct GateKernels {
+    // Butterfly over pairs (i, i | stride); range over [0, size / 2)
+    void (*hadamard)(Real* re, Real* im, size_t stride, size_t begin, size_t end);
+    // Multiply amplitudes whose mask bits are all set by (c + i s);
+    // range over [0, size >> popcount(mask))
+    void (*phase)(Real* re, Real* im, size_t mask, Real c, Real s,
+                  size_t begin, size_t end);
+    // out[i] = a[i] * b[i] * (c + i s) over len elements; out may alias a
+    void (*diagonal)(Real* out_re, Real* out_im, const Real* a_re, const Real* a_im,
+                     const Real* b_re, const Real* b_im, Real c, Real s, size_t len);
+    const char* name;
+};
+
+namespace detail {
+
+constexpr double kInvSqrt2 = 0.70710678118654752440;
+
+template <typename Real>
+inline void hadamardRunScalar(Real* re, Real* im, size_t i0, size_t i1, size_t len) {
+    const Real h = static_cast<Real>(kInvSqrt2);
+    for (size_t j = 0; j < len; ++j) {
+        Real r0 = re[i0 + j], m0 = im[i0 + j];
+        Real r1 = re[i1 + j], m1 = im[i1 + j];
+        re[i0 + j] = h * (r0 + r1);
+        im[i0 + j] = h * (m0 + m1);
+        re[i1 + j] = h * (r0 - r1);
+        im[i1 + j] = h * (m0 - m1);
+    }
+}
+
+template <typename Real>
+inline void phaseRunScalar(Real* re, Real* im, size_t i, size_t len, Real c, Real s) {
+    for (size_t j = i; j < i + len; ++j) {
+        Real r = re[j], m = im[j];
+        re[j] = r * c - m * s;
+        im[j] = r * s + m * c;
+    }
+}
+
+template <typename Real>
+inline void diagonalScalar(Real* out_re, Real* out_im, const Real* a_re, const Real* a_im,
+                           const Real* b_re, const Real* b_im, Real c, Real s, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        Real pr = a_re[i] * b_re[i] - a_im[i] * b_im[i];
+        Real pi = a_re[i] * b_im[i] + a_im[i] * b_re[i];
+        out_re[i] = pr * c - pi * s;
+        out_im[i] = pr * s + pi * c;
+    }
+}
+
+// Length of the contiguous run starting at compressed index k
+inline size_t runLength(size_t k, size_t end, size_t run) {
+    size_t len = run - (k & (run - 1));
+    return len < end - k ? len : end - k;
+}
+
+// Walk the compressed range in contiguous runs and hand each run to
+// `body(first_index, length)`. The SIMD kernels spell this loop out because
+// lambdas do not inherit their target attributes.
+template <typename Body>
+inline void forEachRun(size_t mask, size_t run, size_t begin, size_t end, Body&& body) {
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, run);
+        body(depositZeros(k, mask), len);
+    }
+}
+
+template <typename Real>
+inline void hadamardScalar(Real* re, Real* im, size_t stride, size_t begin, size_t end) {
+    forEachRun(stride, stride, begin, end, [&](size_t i0, size_t len) {
+        hadamardRunScalar(re, im, i0, i0 | stride, len);
+    });
+}
+
+template <typename Real>
+inline void phaseScalar(Real* re, Real* im, size_t mask, Real c, Real s,
+                        size_t begin, size_t end) {
+    size_t run = mask & (~mask + 1);
+    forEachRun(mask, run, begin, end, [&](size_t i, size_t len) {
+        phaseRunScalar(re, im, i | mask, len, c, s);
+    });
+}
+
+#ifdef QUARTZ_X86_SIMD
+
+__attribute__((target("avx2,fma")))
+inline void hadamardAvx2(double* re, double* im, size_t stride, size_t begin, size_t end) {
+    if (stride < 4) {
+        hadamardScalar(re, im, stride, begin, end);
+        return;
+    }
+    const __m256d h = _mm256_set1_pd(static_cast<double>(kInvSqrt2));
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, stride);
+        size_t i0 = depositZeros(k, stride), i1 = i0 | stride;
+        size_t j = 0;
+        for (; j + 4 <= len; j += 4) {
+            __m256d r0 = _mm256_loadu_pd(re + i0 + j), m0 = _mm256_loadu_pd(im + i0 + j);
+            __m256d r1 = _mm256_loadu_pd(re + i1 + j), m1 = _mm256_loadu_pd(im + i1 + j);
+            _mm256_storeu_pd(re + i0 + j, _mm256_mul_pd(h, _mm256_add_pd(r0, r1)));
+            _mm256_storeu_pd(im + i0 + j, _mm256_mul_pd(h, _mm256_add_pd(m0, m1)));
+            _mm256_storeu_pd(re + i1 + j, _mm256_mul_pd(h, _mm256_sub_pd(r0, r1)));
+            _mm256_storeu_pd(im + i1 + j, _mm256_mul_pd(h, _mm256_sub_pd(m0, m1)));
+        }
+        hadamardRunScalar(re, im, i0 + j, i1 + j, len - j);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void phaseAvx2(double* re, double* im, size_t mask, double c, double s,
+                      size_t begin, size_t end) {
+    size_t run = mask & (~mask + 1);
+    if (run < 4) {
+        phaseScalar(re, im, mask, c, s, begin, end);
+        return;
+    }
+    const __m256d vc = _mm256_set1_pd(c), vs = _mm256_set1_pd(s);
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, run);
+        size_t i = depositZeros(k, mask) | mask;
+        size_t j = 0;
+        for (; j + 4 <= len; j += 4) {
+            __m256d r = _mm256_loadu_pd(re + i + j), m = _mm256_loadu_pd(im + i + j);
+            _mm256_storeu_pd(re + i + j, _mm256_fmsub_pd(r, vc, _mm256_mul_pd(m, vs)));
+            _mm256_storeu_pd(im + i + j, _mm256_fmadd_pd(r, vs, _mm256_mul_pd(m, vc)));
+        }
+        phaseRunScalar(re, im, i + j, len - j, c, s);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void diagonalAvx2(double* out_re, double* out_im, const double* a_re, const double* a_im,
+                         const double* b_re, const double* b_im, double c, double s, size_t len) {
+    const __m256d vc = _mm256_set1_pd(c), vs = _mm256_set1_pd(s);
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m256d ar = _mm256_loadu_pd(a_re + i), ai = _mm256_loadu_pd(a_im + i);
+        __m256d br = _mm256_loadu_pd(b_re + i), bi = _mm256_loadu_pd(b_im + i);
+        __m256d pr = _mm256_fmsub_pd(ar, br, _mm256_mul_pd(ai, bi));
+        __m256d pi = _mm256_fmadd_pd(ar, bi, _mm256_mul_pd(ai, br));
+        _mm256_storeu_pd(out_re + i, _mm256_fmsub_pd(pr, vc, _mm256_mul_pd(pi, vs)));
+        _mm256_storeu_pd(out_im + i, _mm256_fmadd_pd(pr, vs, _mm256_mul_pd(pi, vc)));
+    }
+    diagonalScalar(out_re + i, out_im + i, a_re + i, a_im + i, b_re + i, b_im + i, c, s, len - i);
+}
+
+__attribute__((target("avx2,fma")))
+inline void hadamardAvx2(float* re, float* im, size_t stride, size_t begin, size_t end) {
+    if (stride < 8) {
+        hadamardScalar(re, im, stride, begin, end);
+        return;
+    }
+    const __m256 h = _mm256_set1_ps(static_cast<float>(kInvSqrt2));
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, stride);
+        size_t i0 = depositZeros(k, stride), i1 = i0 | stride;
+        size_t j = 0;
+        for (; j + 8 <= len; j += 8) {
+            __m256 r0 = _mm256_loadu_ps(re + i0 + j), m0 = _mm256_loadu_ps(im + i0 + j);
+            __m256 r1 = _mm256_loadu_ps(re + i1 + j), m1 = _mm256_loadu_ps(im + i1 + j);
+            _mm256_storeu_ps(re + i0 + j, _mm256_mul_ps(h, _mm256_add_ps(r0, r1)));
+            _mm256_storeu_ps(im + i0 + j, _mm256_mul_ps(h, _mm256_add_ps(m0, m1)));
+            _mm256_storeu_ps(re + i1 + j, _mm256_mul_ps(h, _mm256_sub_ps(r0, r1)));
+            _mm256_storeu_ps(im + i1 + j, _mm256_mul_ps(h, _mm256_sub_ps(m0, m1)));
+        }
+        hadamardRunScalar(re, im, i0 + j, i1 + j, len - j);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void phaseAvx2(float* re, float* im, size_t mask, float c, float s,
+                      size_t begin, size_t end) {
+    size_t run = mask & (~mask + 1);
+    if (run < 8) {
+        phaseScalar(re, im, mask, c, s, begin, end);
+        return;
+    }
+    const __m256 vc = _mm256_set1_ps(c), vs = _mm256_set1_ps(s);
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, run);
+        size_t i = depositZeros(k, mask) | mask;
+        size_t j = 0;
+        for (; j + 8 <= len; j += 8) {
+            __m256 r = _mm256_loadu_ps(re + i + j), m = _mm256_loadu_ps(im + i + j);
+            _mm256_storeu_ps(re + i + j, _mm256_fmsub_ps(r, vc, _mm256_mul_ps(m, vs)));
+            _mm256_storeu_ps(im + i + j, _mm256_fmadd_ps(r, vs, _mm256_mul_ps(m, vc)));
+        }
+        phaseRunScalar(re, im, i + j, len - j, c, s);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void diagonalAvx2(float* out_re, float* out_im, const float* a_re, const float* a_im,
+                         const float* b_re, const float* b_im, float c, float s, size_t len) {
+    const __m256 vc = _mm256_set1_ps(c), vs = _mm256_set1_ps(s);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256 ar = _mm256_loadu_ps(a_re + i), ai = _mm256_loadu_ps(a_im + i);
+        __m256 br = _mm256_loadu_ps(b_re + i), bi = _mm256_loadu_ps(b_im + i);
+        __m256 pr = _mm256_fmsub_ps(ar, br, _mm256_mul_ps(ai, bi));
+        __m256 pi = _mm256_fmadd_ps(ar, bi, _mm256_mul_ps(ai, br));
+        _mm256_storeu_ps(out_re + i, _mm256_fmsub_ps(pr, vc, _mm256_mul_ps(pi, vs)));
+        _mm256_storeu_ps(out_im + i, _mm256_fmadd_ps(pr, vs, _mm256_mul_ps(pi, vc)));
+    }
+    diagonalScalar(out_re + i, out_im + i, a_re + i, a_im + i, b_re + i, b_im + i, c, s, len - i);
+}
+
+__attribute__((target("avx512f")))
+inline void hadamardAvx512(double* re, double* im, size_t stride, size_t begin, size_t end) {
+    if (stride < 8) {
+        hadamardAvx2(re, im, stride, begin, end);
+        return;
+    }
+    const __m512d h = _mm512_set1_pd(static_cast<double>(kInvSqrt2));
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, stride);
+        size_t i0 = depositZeros(k, stride), i1 = i0 | stride;
+        size_t j = 0;
+        for (; j + 8 <= len; j += 8) {
+            __m512d r0 = _mm512_loadu_pd(re + i0 + j), m0 = _mm512_loadu_pd(im + i0 + j);
+            __m512d r1 = _mm512_loadu_pd(re + i1 + j), m1 = _mm512_loadu_pd(im + i1 + j);
+            _mm512_storeu_pd(re + i0 + j, _mm512_mul_pd(h, _mm512_add_pd(r0, r1)));
+            _mm512_storeu_pd(im + i0 + j, _mm512_mul_pd(h, _mm512_add_pd(m0, m1)));
+            _mm512_storeu_pd(re + i1 + j, _mm512_mul_pd(h, _mm512_sub_pd(r0, r1)));
+            _mm512_storeu_pd(im + i1 + j, _mm512_mul_pd(h, _mm512_sub_pd(m0, m1)));
+        }
+        hadamardRunScalar(re, im, i0 + j, i1 + j, len - j);
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void phaseAvx512(double* re, double* im, size_t mask, double c, double s,
+                        size_t begin, size_t end) {
+    size_t run = mask & (~mask + 1);
+    if (run < 8) {
+        phaseAvx2(re, im, mask, c, s, begin, end);
+        return;
+    }
+    const __m512d vc = _mm512_set1_pd(c), vs = _mm512_set1_pd(s);
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, run);
+        size_t i = depositZeros(k, mask) | mask;
+        size_t j = 0;
+        for (; j + 8 <= len; j += 8) {
+            __m512d r = _mm512_loadu_pd(re + i + j), m = _mm512_loadu_pd(im + i + j);
+            _mm512_storeu_pd(re + i + j, _mm512_fmsub_pd(r, vc, _mm512_mul_pd(m, vs)));
+            _mm512_storeu_pd(im + i + j, _mm512_fmadd_pd(r, vs, _mm512_mul_pd(m, vc)));
+        }
+        phaseRunScalar(re, im, i + j, len - j, c, s);
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void diagonalAvx512(double* out_re, double* out_im, const double* a_re, const double* a_im,
+                           const double* b_re, const double* b_im, double c, double s, size_t len) {
+    const __m512d vc = _mm512_set1_pd(c), vs = _mm512_set1_pd(s);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m512d ar = _mm512_loadu_pd(a_re + i), ai = _mm512_loadu_pd(a_im + i);
+        __m512d br = _mm512_loadu_pd(b_re + i), bi = _mm512_loadu_pd(b_im + i);
+        __m512d pr = _mm512_fmsub_pd(ar, br, _mm512_mul_pd(ai, bi));
+        __m512d pi = _mm512_fmadd_pd(ar, bi, _mm512_mul_pd(ai, br));
+        _mm512_storeu_pd(out_re + i, _mm512_fmsub_pd(pr, vc, _mm512_mul_pd(pi, vs)));
+        _mm512_storeu_pd(out_im + i, _mm512_fmadd_pd(pr, vs, _mm512_mul_pd(pi, vc)));
+    }
+    diagonalScalar(out_re + i, out_im + i, a_re + i, a_im + i, b_re + i, b_im + i, c, s, len - i);
+}
+
+__attribute__((target("avx512f")))
+inline void hadamardAvx512(float* re, float* im, size_t stride, size_t begin, size_t end) {
+    if (stride < 16) {
+        hadamardAvx2(re, im, stride, begin, end);
+        return;
+    }
+    const __m512 h = _mm512_set1_ps(static_cast<float>(kInvSqrt2));
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, stride);
+        size_t i0 = depositZeros(k, stride), i1 = i0 | stride;
+        size_t j = 0;
+        for (; j + 16 <= len; j += 16) {
+            __m512 r0 = _mm512_loadu_ps(re + i0 + j), m0 = _mm512_loadu_ps(im + i0 + j);
+            __m512 r1 = _mm512_loadu_ps(re + i1 + j), m1 = _mm512_loadu_ps(im + i1 + j);
+            _mm512_storeu_ps(re + i0 + j, _mm512_mul_ps(h, _mm512_add_ps(r0, r1)));
+            _mm512_storeu_ps(im + i0 + j, _mm512_mul_ps(h, _mm512_add_ps(m0, m1)));
+            _mm512_storeu_ps(re + i1 + j, _mm512_mul_ps(h, _mm512_sub_ps(r0, r1)));
+            _mm512_storeu_ps(im + i1 + j, _mm512_mul_ps(h, _mm512_sub_ps(m0, m1)));
+        }
+        hadamardRunScalar(re, im, i0 + j, i1 + j, len - j);
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void phaseAvx512(float* re, float* im, size_t mask, float c, float s,
+                        size_t begin, size_t end) {
+    size_t run = mask & (~mask + 1);
+    if (run < 16) {
+        phaseAvx2(re, im, mask, c, s, begin, end);
+        return;
+    }
+    const __m512 vc = _mm512_set1_ps(c), vs = _mm512_set1_ps(s);
+    for (size_t k = begin, len; k < end; k += len) {
+        len = runLength(k, end, run);
+        size_t i = depositZeros(k, mask) | mask;
+        size_t j = 0;
+        for (; j + 16 <= len; j += 16) {
+            __m512 r = _mm512_loadu_ps(re + i + j), m = _mm512_loadu_ps(im + i + j);
+            _mm512_storeu_ps(re + i + j, _mm512_fmsub_ps(r, vc, _mm512_mul_ps(m, vs)));
+            _mm512_storeu_ps(im + i + j, _mm512_fmadd_ps(r, vs, _mm512_mul_ps(m, vc)));
+        }
+        phaseRunScalar(re, im, i + j, len - j, c, s);
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void diagonalAvx512(float* out_re, float* out_im, const float* a_re, const float* a_im,
+                           const float* b_re, const float* b_im, float c, float s, size_t len) {
+    const __m512 vc = _mm512_set1_ps(c), vs = _mm512_set1_ps(s);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m512 ar = _mm512_loadu_ps(a_re + i), ai = _mm512_loadu_ps(a_im + i);
+        __m512 br = _mm512_loadu_ps(b_re + i), bi = _mm512_loadu_ps(b_im + i);
+        __m512 pr = _mm512_fmsub_ps(ar, br, _mm512_mul_ps(ai, bi));
+        __m512 pi = _mm512_fmadd_ps(ar, bi, _mm512_mul_ps(ai, br));
+        _mm512_storeu_ps(out_re + i, _mm512_fmsub_ps(pr, vc, _mm512_mul_ps(pi, vs)));
+        _mm512_storeu_ps(out_im + i, _mm512_fmadd_ps(pr, vs, _mm512_mul_ps(pi, vc)));
+    }
+    diagonalScalar(out_re + i, out_im + i, a_re + i, a_im + i, b_re + i, b_im + i, c, s, len - i);
+}
+
+#endif // QUARTZ_X86_SIMD
+
+template <typename Real>
+inline GateKernels<Real> selectKernels() {
+#ifdef QUARTZ_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {hadamardAvx512, phaseAvx512, diagonalAvx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {hadamardAvx2, phaseAvx2, diagonalAvx2, "avx2"};
+    }
+#endif
+    return {hadamardScalar<Real>, phaseScalar<Real>, diagonalScalar<Real>, "scalar"};
+}
+
+} // namespace detail
+
+template <typename Real = double>
+inline const GateKernels<Real>& scalarKernels() {
+    static const GateKernels<Real> table{detail::hadamardScalar<Real>, detail::phaseScalar<Real>,
+                                         detail::diagonalScalar<Real>, "scalar"};
+    return table;
+}
+
+// Best kernels for the running CPU, picked once via CPUID
+template <typename Real = double>
+inline const GateKernels<Real>& gateKernels() {
+    static const GateKernels<Real> table = detail::selectKernels<Real>();
+    return table;
+}
+
+// Dense vector kernels for the linear algebra around the state vector
+// (risk column sums, covariance products)
+struct VectorKernels {
+    // y[i] += a * x[i] over n elements
+    void (*axpy)(double a, const double* x, double* y, size_t n);
+    const char* name;
+};
+
+namespace detail {
+
+inline void axpyScalar(double a, const double* x, double* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) y[i] += a * x[i];
+}
+
+#ifdef QUARTZ_X86_SIMD
+
+__attribute__((target("avx2,fma")))
+inline void axpyAvx2(double a, const double* x, double* y, size_t n) {
+    const __m256d va = _mm256_set1_pd(a);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d y0 = _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i));
+        __m256d y1 = _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4));
+        _mm256_storeu_pd(y + i, y0);
+        _mm256_storeu_pd(y + i + 4, y1);
+    }
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+__attribute__((target("avx512f")))
+inline void axpyAvx512(double a, const double* x, double* y, size_t n) {
+    const __m512d va = _mm512_set1_pd(a);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512d y0 = _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i));
+        __m512d y1 = _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8));
+        _mm512_storeu_pd(y + i, y0);
+        _mm512_storeu_pd(y + i + 8, y1);
+    }
+    // Short columns and tails: one masked step covers up to 8 elements
+    for (; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? __mmask8(0xFF) : __mmask8((1u << (n - i)) - 1);
+        __m512d yi = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i),
+                                     _mm512_maskz_loadu_pd(m, y + i));
+        _mm512_mask_storeu_pd(y + i, m, yi);
+    }
+}
+
+#endif // QUARTZ_X86_SIMD
+
+inline VectorKernels selectVectorKernels() {
+#ifdef QUARTZ_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {axpyAvx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {axpyAvx2, "avx2"};
+    }
+#endif
+    return {axpyScalar, "scalar"};
+}
+
+} // namespace detail
+
+inline const VectorKernels& vectorKernels() {
+    static const VectorKernels table = detail::selectVectorKernels();
+    return table;
+}
+
+} // namespace kernels
+} // namespace quantum_allocation
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace quantum_allocation {
+
+// Fixed-size pool for data-parallel loops. A parallelFor splits its range into
+// grain-sized chunks whose boundaries depend only on the range and grain, never
+// on the number of threads, so per-chunk partial results combined in chunk
+// order are bit-for-bit reproducible. Chunks are dealt out in contiguous
+// stretches, one per thread; a thread that finishes its stretch steals single
+// chunks from the others.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads = 0, bool pin_threads = false) {
+        if (num_threads == 0) {
+            num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        slots_ = std::make_unique<Slot[]>(num_threads);
+        num_threads_ = num_threads;
+
+        // The calling thread acts as worker 0
+        for (size_t i = 1; i < num_threads; ++i) {
+            workers_.emplace_back([this, i] { workerLoop(i); });
+            if (pin_threads) pin(workers_.back(), i);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return num_threads_; }
+
+    static size_t numChunks(size_t begin, size_t end, size_t grain) {
+        return end > begin ? (end - begin + grain - 1) / grain : 0;
+    }
+
+    // Runs fn(chunk_begin, chunk_end, worker_index) over [begin, end);
+    // worker_index is always below size(). Calls made from inside a running
+    // loop of this pool execute inline on the calling worker. Any other
+    // caller, including a worker of a different pool, runs as this pool's
+    // worker 0 and is serialized with other callers, inline or not.
+    template <typename Fn>
+    void parallelFor(size_t begin, size_t end, size_t grain, Fn&& fn) {
+        size_t chunks = numChunks(begin, end, grain);
+        if (chunks == 0) return;
+
+        if (loop_pool_ == this) {
+            runInline(begin, end, grain, chunks, fn, current_worker_);
+            return;
+        }
+
+        std::lock_guard<std::mutex> submit(submit_mutex_);
+        if (chunks == 1 || num_threads_ == 1) {
+            LoopScope scope(this, 0);
+            runInline(begin, end, grain, chunks, fn, 0);
+            return;
+        }
+
+        Job job;
+        job.begin = begin;
+        job.end = end;
+        job.grain = grain;
+        job.context = &fn;
+        job.invoke = [](void* ctx, size_t b, size_t e, size_t worker) {
+            (*static_cast<std::remove_reference_t<Fn>*>(ctx))(b, e, worker);
+        };
+
+        size_t per_thread = (chunks + num_threads_ - 1) / num_threads_;
+        for (size_t i = 0; i < num_threads_; ++i) {
+            size_t first = std::min(chunks, i * per_thread);
+            slots_[i].next.store(first, std::memory_order_relaxed);
+            slots_[i].end = std::min(chunks, first + per_thread);
+        }
+        remaining_.store(chunks, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        runChunks(job, 0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] {
+            return remaining_.load(std::memory_order_acquire) == 0 && active_ == 0;
+        });
+        job_ = nullptr;
+    }
+
+    // Restricts a thread to one core (no-op off Linux)
+    static void pin(std::thread& thread, size_t core) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core % CPU_SETSIZE, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)core;
+#endif
+    }
+
+private:
+    struct Job {
+        size_t begin, end, grain;
+        void* context;
+        void (*invoke)(void*, size_t, size_t, size_t);
+    };
+
+    // Marks the calling thread as worker `index` of a pool while it runs
+    // that pool's chunks, restoring the pool it was serving before
+    struct LoopScope {
+        LoopScope(const ThreadPool* pool, size_t index)
+            : previous_pool(loop_pool_), previous_worker(current_worker_) {
+            loop_pool_ = pool;
+            current_worker_ = index;
+        }
+        ~LoopScope() {
+            loop_pool_ = previous_pool;
+            current_worker_ = previous_worker;
+        }
+        const ThreadPool* previous_pool;
+        size_t previous_worker;
+    };
+
+    template <typename Fn>
+    static void runInline(size_t begin, size_t end, size_t grain, size_t chunks, Fn& fn,
+                          size_t worker) {
+        for (size_t c = 0; c < chunks; ++c) {
+            size_t b = begin + c * grain;
+            fn(b, std::min(end, b + grain), worker);
+        }
+    }
+
+    struct alignas(64) Slot {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    void workerLoop(size_t index) {
+        size_t seen = 0;
+        for (;;) {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+                job = job_;
+                if (!job) continue;  // Woke after the loop already finished
+                ++active_;
+            }
+            runChunks(*job, index);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --active_;
+            }
+            done_.notify_all();
+        }
+    }
+
+    void runChunks(const Job& job, size_t index) {
+        LoopScope scope(this, index);
+        for (size_t v = 0; v < num_threads_; ++v) {
+            // Own stretch first, then steal from the others in turn
+            Slot& slot = slots_[(index + v) % num_threads_];
+            for (;;) {
+                size_t c = slot.next.fetch_add(1, std::memory_order_relaxed);
+                if (c >= slot.end) break;
+                size_t b = job.begin + c * job.grain;
+                job.invoke(job.context, b, std::min(job.end, b + job.grain), index);
+                remaining_.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+    }
+
+    size_t num_threads_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job* job_ = nullptr;
+    size_t generation_ = 0;
+    size_t active_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> remaining_{0};
+
+    // Pool whose loop the current thread is running, and its index there
+    static inline thread_local const ThreadPool* loop_pool_ = nullptr;
+    static inline thread_local size_t current_worker_ = 0;
+};
+
+} // namespace quantum_allocation
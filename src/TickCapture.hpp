@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "QuoteTable.hpp"
+
+namespace quantum_allocation {
+
+// On-disk tick log: a 32-byte header followed by fixed-width 48-byte
+// records. A symbol definition record (kSymbolDefinition set) precedes the
+// first tick of each symbol and carries its name in the payload bytes, so
+// the file is self-describing and can be appended to without a trailer.
+struct TickFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    int64_t created_ns;
+    uint64_t reserved;
+};
+
+struct TickRecord {
+    static constexpr uint32_t kSymbolDefinition = 1;
+    static constexpr size_t kMaxSymbolLength = 32;
+
+    int64_t timestamp_ns;
+    uint32_t symbol;
+    uint32_t flags;
+    union {
+        struct {
+            double price;
+            double volume;
+            double bid;
+            double ask;
+        } quote;
+        char name[kMaxSymbolLength];
+    };
+};
+
+static_assert(sizeof(TickFileHeader) == 32, "tick file header layout changed");
+static_assert(sizeof(TickRecord) == 48, "tick record layout changed");
+
+constexpr char kTickFileMagic[8] = {'Q', 'A', 'T', 'I', 'C', 'K', 'S', '\0'};
+constexpr uint32_t kTickFileVersion = 1;
+
+// Bounded single-producer/single-consumer queue. Head and tail live on
+// separate cache lines; each side caches the other's index so the common
+// case touches no shared line.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : mask_(roundUp(capacity) - 1), items_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    bool tryPush(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) return false;
+        }
+        items_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops up to max items into out; returns how many
+    size_t popBatch(T* out, size_t max) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return 0;
+        }
+        size_t count = std::min(max, tail_cache_ - head);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = items_[(head + i) & mask_];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    size_t mask_;
+    std::unique_ptr<T[]> items_;
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+};
+
+// Appends ticks to a capture file off the hot path. Each producer thread
+// (one per feed connection) owns an SPSC ring; a background thread drains
+// all rings into a buffered file. A full ring drops the tick and counts it
+// rather than stall the feed. Records from different producers are written
+// in drain order, so timestamps are only ordered per producer.
+class TickRecorder {
+public:
+    static constexpr size_t kDefaultRingCapacity = 1 << 16;
+
+    TickRecorder(const std::string& path, const SymbolTable& symbols, size_t num_producers,
+                 size_t ring_capacity = kDefaultRingCapacity)
+        : symbols_(symbols) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("Cannot open tick capture file " + path);
+
+        TickFileHeader header{};
+        std::memcpy(header.magic, kTickFileMagic, sizeof(header.magic));
+        header.version = kTickFileVersion;
+        header.record_size = sizeof(TickRecord);
+        header.created_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::fwrite(&header, sizeof(header), 1, file_);
+
+        for (size_t i = 0; i < num_producers; ++i) {
+            rings_.push_back(std::make_unique<SpscRing<TickRecord>>(ring_capacity));
+        }
+        writer_ = std::thread([this] { writerLoop(); });
+    }
+
+    ~TickRecorder() {
+        stopping_.store(true, std::memory_order_release);
+        writer_.join();
+        std::fclose(file_);
+    }
+
+    TickRecorder(const TickRecorder&) = delete;
+    TickRecorder& operator=(const TickRecorder&) = delete;
+
+    // Called only from the producer thread that owns ring `producer`
+    void record(size_t producer, SymbolId symbol, double price, double volume, double bid,
+                double ask, std::chrono::system_clock::time_point timestamp) {
+        TickRecord record;
+        record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            timestamp.time_since_epoch()).count();
+        record.symbol = symbol;
+        record.flags = 0;
+        record.quote = {price, volume, bid, ask};
+        if (!rings_[producer]->tryPush(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t recorded() const {
+        return recorded_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t kBatch = 1024;
+
+    void writerLoop() {
+        std::vector<TickRecord> batch(kBatch);
+        for (;;) {
+            bool stopping = stopping_.load(std::memory_order_acquire);
+            size_t drained = 0;
+            for (auto& ring : rings_) {
+                size_t count;
+                while ((count = ring->popBatch(batch.data(), kBatch)) > 0) {
+                    write(batch.data(), count);
+                    drained += count;
+                }
+            }
+            // Rings were emptied after the stop flag was seen, so nothing is lost
+            if (stopping) break;
+            if (drained == 0) {
+                std::fflush(file_);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        std::fflush(file_);
+    }
+
+    void write(const TickRecord* records, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            SymbolId id = records[i].symbol;
+            if (id >= defined_.size()) defined_.resize(id + 1, false);
+            if (!defined_[id]) {
+                writeDefinition(id, records[i].timestamp_ns);
+                defined_[id] = true;
+            }
+        }
+        std::fwrite(records, sizeof(TickRecord), count, file_);
+        recorded_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void writeDefinition(SymbolId id, int64_t timestamp_ns) {
+        const std::string& name = symbols_.name(id);
+        TickRecord record{};
+        record.timestamp_ns = timestamp_ns;
+        record.symbol = id;
+        record.flags = TickRecord::kSymbolDefinition;
+        std::memcpy(record.name, name.data(), std::min(name.size(), TickRecord::kMaxSymbolLength));
+        std::fwrite(&record, sizeof(record), 1, file_);
+    }
+
+    const SymbolTable& symbols_;
+    std::FILE* file_ = nullptr;
+    std::vector<std::unique_ptr<SpscRing<TickRecord>>> rings_;
+    std::vector<bool> defined_;
+    std::thread writer_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+// Read-only memory map of a capture file. records() spans every record,
+// symbol definitions included; a trailing partial record (e.g. from a
+// crash mid-write) is ignored.
+class TickReader {
+public:
+    explicit TickReader(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open tick capture file " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickFileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Tick capture file too short: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) throw std::runtime_error("Cannot map tick capture file " + path);
+        data_ = static_cast<const char*>(data);
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+
+        const auto* header = reinterpret_cast<const TickFileHeader*>(data_);
+        if (std::memcmp(header->magic, kTickFileMagic, sizeof(header->magic)) != 0 ||
+            header->version != kTickFileVersion || header->record_size != sizeof(TickRecord)) {
+            ::munmap(data, size_);
+            throw std::runtime_error("Not a tick capture file: " + path);
+        }
+    }
+
+    ~TickReader() {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    TickReader(const TickReader&) = delete;
+    TickReader& operator=(const TickReader&) = delete;
+
+    const TickRecord* records() const {
+        return reinterpret_cast<const TickRecord*>(data_ + sizeof(TickFileHeader));
+    }
+
+    size_t size() const {
+        return (size_ - sizeof(TickFileHeader)) / sizeof(TickRecord);
+    }
+
+    static std::string_view symbolName(const TickRecord& record) {
+        return std::string_view(record.name, strnlen(record.name, TickRecord::kMaxSymbolLength));
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace quantum_allocation
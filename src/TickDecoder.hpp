@@ -0,0 +1,181 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+
+namespace quantum_allocation {
+
+// One quote as it appears on the wire. symbol points into the decoded
+// message and is only valid while that buffer is.
+struct Tick {
+    std::string_view symbol;
+    double price = 0.0;
+    double volume = 0.0;
+    double bid = 0.0;
+    double ask = 0.0;
+};
+
+// Schema-specialized scanner for flat tick objects such as
+//   {"symbol":"AAPL","price":189.3,"volume":1200,"bid":189.29,"ask":189.31}
+// Works in place on the received bytes: no DOM, no copies, no allocation.
+// Unknown keys (including nested objects and arrays) are skipped, numbers
+// may be bare or quoted, and key order does not matter. Anything outside
+// that shape (escaped symbol, missing field, malformed input, bytes after
+// the object) returns false so the caller can fall back to a general JSON
+// parser.
+class TickDecoder {
+public:
+    static bool decode(const char* data, size_t size, Tick& tick) {
+        Cursor c{data, data + size};
+        unsigned seen = 0;
+
+        c.skipSpace();
+        if (!c.consume('{')) return false;
+        c.skipSpace();
+        if (c.consume('}')) return false;
+
+        for (;;) {
+            std::string_view key;
+            if (!c.string(key)) return false;
+            c.skipSpace();
+            if (!c.consume(':')) return false;
+            c.skipSpace();
+
+            unsigned field = fieldOf(key);
+            bool ok;
+            switch (field) {
+            case kSymbol: ok = c.string(tick.symbol); break;
+            case kPrice:  ok = c.number(tick.price); break;
+            case kVolume: ok = c.number(tick.volume); break;
+            case kBid:    ok = c.number(tick.bid); break;
+            case kAsk:    ok = c.number(tick.ask); break;
+            default:      ok = c.skipValue(0); break;
+            }
+            if (!ok) return false;
+            seen |= field;
+
+            c.skipSpace();
+            if (c.consume('}')) break;
+            if (!c.consume(',')) return false;
+            c.skipSpace();
+        }
+        // One object per message: trailing bytes go to the fallback
+        c.skipSpace();
+        return c.p == c.end && seen == kAllFields;
+    }
+
+private:
+    enum : unsigned {
+        kSymbol = 1, kPrice = 2, kVolume = 4, kBid = 8, kAsk = 16,
+        kAllFields = 31
+    };
+
+    // Nesting limit for skipped values; deeper input goes to the fallback
+    static constexpr int kMaxDepth = 32;
+
+    static unsigned fieldOf(std::string_view key) {
+        switch (key.size()) {
+        case 3:
+            if (key == "bid") return kBid;
+            if (key == "ask") return kAsk;
+            break;
+        case 5:
+            if (key == "price") return kPrice;
+            break;
+        case 6:
+            if (key == "symbol") return kSymbol;
+            if (key == "volume") return kVolume;
+            break;
+        }
+        return 0;
+    }
+
+    struct Cursor {
+        const char* p;
+        const char* end;
+
+        void skipSpace() {
+            while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+        }
+
+        bool consume(char ch) {
+            if (p < end && *p == ch) {
+                ++p;
+                return true;
+            }
+            return false;
+        }
+
+        // Strings with escapes are rejected rather than unescaped in place
+        bool string(std::string_view& out) {
+            if (!consume('"')) return false;
+            const char* start = p;
+            while (p < end && *p != '"') {
+                if (*p == '\\') return false;
+                ++p;
+            }
+            if (p == end) return false;
+            out = std::string_view(start, p - start);
+            ++p;
+            return true;
+        }
+
+        bool number(double& out) {
+            bool quoted = consume('"');
+            auto result = std::from_chars(p, end, out);
+            if (result.ec != std::errc()) return false;
+            p = result.ptr;
+            return !quoted || consume('"');
+        }
+
+        bool skipValue(int depth) {
+            if (p == end || depth > kMaxDepth) return false;
+            switch (*p) {
+            case '"': {
+                ++p;
+                while (p < end && *p != '"') {
+                    if (*p == '\\') ++p;
+                    ++p;
+                }
+                if (p >= end) return false;
+                ++p;
+                return true;
+            }
+            case '{':
+            case '[': {
+                const char close = *p == '{' ? '}' : ']';
+                ++p;
+                skipSpace();
+                if (consume(close)) return true;
+                for (;;) {
+                    if (close == '}') {
+                        std::string_view key;
+                        if (!string(key)) return false;
+                        skipSpace();
+                        if (!consume(':')) return false;
+                        skipSpace();
+                    }
+                    if (!skipValue(depth + 1)) return false;
+                    skipSpace();
+                    if (consume(close)) return true;
+                    if (!consume(',')) return false;
+                    skipSpace();
+                }
+            }
+            default: {
+                // Number or literal: up to the next delimiter
+                const char* start = p;
+                while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+                       *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+                    ++p;
+                }
+                return p > start;
+            }
+            }
+        }
+    };
+};
+
+} // namespace quantum_allocation
@@ -1,10 +1,20 @@
 #include "QuantumOptimizer.hpp"
+#include "ClassicalOptimizer.hpp"
 #include "MarketIntegration.hpp"
 #include "FixTrading.hpp"
 #include "LuaInterface.hpp"
+#include "ThreadPool.hpp"
+#include "ReturnStatistics.hpp"
+#include "RebalanceScheduler.hpp"
+#include "MonteCarloRisk.hpp"
+#include "RiskGate.hpp"
+#include "OrderManager.hpp"
+#include "PositionBook.hpp"
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <cmath>
 #include <fstream>
+#include <mutex>
 #include <thread>
 #include <yaml-cpp/yaml.h>
 
@@ -17,28 +27,63 @@ public:
         std::string market_host;
         std::string market_port;
         std::vector<std::string> symbols;
+        size_t market_connections = 1;  // Symbols are spread across this many sockets
+        bool pin_feed_threads = false;
+        int feed_first_core = -1;       // -1 = just past the pinned thread pool workers
+        size_t symbol_headroom = 256;   // Symbol table slots beyond the configured list
+        std::string capture_path;  // Record decoded ticks here when set
         
         // Optimization parameters
         double risk_aversion;
         double initial_temperature;
         int num_iterations;
         double learning_rate;
+        std::string backend = "quantum";   // "quantum" or "classical"
+        std::string precision = "double";  // Amplitude storage: "double" or "float"
+        double convergence_tolerance = 0.0;  // 0 = always run num_iterations
+        bool warm_start = false;
+
+        // Bar aggregation
+        double bar_interval_seconds = 60.0;
+        double volume_bar_threshold = 0.0;  // 0 = time bars only
+        size_t bar_capacity = 1024;
+
+        // Return statistics
+        size_t stats_window = 252;  // Bars in the sliding covariance window
+        double ewma_lambda = 0.94;  // 0 disables the EWMA estimator
+        bool use_ewma = false;      // Feed the EWMA estimate to the optimizer
+
+        // Parallel execution
+        size_t num_threads = 0;  // 0 = hardware concurrency
+        bool pin_threads = false;
         
         // Trading parameters
-        int rebalance_interval;
+        int rebalance_interval;  // Longest gap between rebalances (seconds)
+        int min_rebalance_interval_ms = 1000;  // Bursts of triggers coalesce within this
+        int scheduler_poll_ms = 50;
+        double price_move_threshold = 0.005;      // Relative move since last rebalance; 0 = off
+        double covariance_drift_threshold = 0.10;  // Relative Frobenius drift; 0 = off
         double min_trade_size;
         double max_position_size;
+        double capital = 0.0;  // Account value the pre-trade limits are fractions of; 0 = no gate
+        double amend_price_tolerance = 0.0005;  // Working orders within this stay untouched
+        double max_daily_turnover = 0.0;
         
         // Risk parameters
         double var_confidence;
         double max_drawdown_limit;
+        double var_limit = 0.0;  // Streaming VaR that forces a rebalance; 0 = off
+        std::string var_method = "historical";  // "historical" or "monte_carlo"
+        size_t mc_scenarios = 100000;
+        uint64_t mc_seed = 0x5EED;
+        double max_leverage = 0.0;
+        double stop_loss = 0.0;  // Daily loss that halts risk-increasing orders
     };
 
     QuantumAllocationSystem(const std::string& config_path)
         : running_(true),
           ioc_(),
           work_guard_(boost::asio::make_work_guard(ioc_)),
-          market_data_(ioc_),
           fix_trading_(),
           lua_interface_() {
         loadConfig(config_path);
@@ -57,11 +102,23 @@ public:
         });
 
         try {
-            // Initialize market data connection
-            market_data_.connect(config_.market_host, config_.market_port);
-            for (const auto& symbol : config_.symbols) {
-                market_data_.subscribe(symbol);
+            // Initialize market data connection. Pinned pool workers take
+            // cores 0..threads-1, so by default the readers start after them.
+            size_t pool_threads = config_.num_threads > 0
+                ? config_.num_threads
+                : std::max(1u, std::thread::hardware_concurrency());
+            size_t feed_first_core = config_.feed_first_core >= 0
+                ? static_cast<size_t>(config_.feed_first_core)
+                : (config_.pin_threads ? pool_threads : 0);
+            market_data_->connect(config_.market_host, config_.market_port,
+                                 config_.market_connections, config_.pin_feed_threads,
+                                 feed_first_core);
+            symbol_ids_ = market_data_->subscribe(config_.symbols);
+            fix_trading_.prepareOrderTemplates(symbol_ids_);
+            if (!config_.capture_path.empty()) {
+                market_data_->startCapture(config_.capture_path);
             }
+            market_data_->attachBars(*bars_);
 
             // Start FIX trading
             fix_trading_.start();
@@ -73,12 +130,24 @@ public:
                 config_.num_iterations,
                 config_.learning_rate
             };
+            opt_params.convergence_tolerance = config_.convergence_tolerance;
+            opt_params.warm_start = config_.warm_start;
             
-            QuantumOptimizer optimizer(config_.symbols.size(), opt_params);
-            RiskManager risk_manager(config_.var_confidence);
+            thread_pool_ = std::make_unique<ThreadPool>(config_.num_threads, config_.pin_threads);
+            RiskManager risk_manager(config_.var_confidence, static_cast<int>(config_.stats_window),
+                                     thread_pool_.get());
+            if (config_.var_method == "monte_carlo") {
+                MonteCarloVaR::Settings mc_settings;
+                mc_settings.scenarios = config_.mc_scenarios;
+                mc_settings.seed = config_.mc_seed;
+                mc_settings.confidence_level = config_.var_confidence;
+                mc_var_ = std::make_unique<MonteCarloVaR>(mc_settings, thread_pool_.get());
+            }
 
             std::cout << "Starting main optimization loop..." << std::endl;
-            mainLoop(optimizer, risk_manager);
+            auto optimizer = makeOptimizer(opt_params);
+            std::cout << "Using " << optimizer->name() << " optimizer" << std::endl;
+            runRebalancing(*optimizer, risk_manager);
 
         } catch (const std::exception& e) {
             std::cerr << "Fatal error: " << e.what() << std::endl;
@@ -86,11 +155,13 @@ public:
         }
 
         io_thread.join();
+        scheduler_.reset();
     }
 
     void stop() {
         running_ = false;
         fix_trading_.stop();
+        market_data_->stop();
         work_guard_.reset();
         ioc_.stop();
     }
@@ -105,6 +176,11 @@ private:
             config_.market_host = market["host"].as<std::string>();
             config_.market_port = market["port"].as<std::string>();
             config_.symbols = market["symbols"].as<std::vector<std::string>>();
+            config_.market_connections = market["connections"].as<size_t>(1);
+            config_.pin_feed_threads = market["pin_threads"].as<bool>(false);
+            config_.feed_first_core = market["first_core"].as<int>(-1);
+            config_.symbol_headroom = market["symbol_headroom"].as<size_t>(256);
+            config_.capture_path = market["capture_path"].as<std::string>("");
 
             // Load optimization settings
             auto optimization = yaml["optimization"];
@@ -112,17 +188,79 @@ private:
             config_.initial_temperature = optimization["initial_temperature"].as<double>();
             config_.num_iterations = optimization["num_iterations"].as<int>();
             config_.learning_rate = optimization["learning_rate"].as<double>();
+            config_.backend = optimization["backend"].as<std::string>("quantum");
+            if (config_.backend != "quantum" && config_.backend != "classical") {
+                throw std::runtime_error("optimization.backend must be \"quantum\" or \"classical\"");
+            }
+            config_.convergence_tolerance = optimization["convergence_tolerance"].as<double>(0.0);
+            config_.warm_start = optimization["warm_start"].as<bool>(false);
+            config_.precision = optimization["precision"].as<std::string>("double");
+            if (config_.precision != "double" && config_.precision != "float") {
+                throw std::runtime_error("optimization.precision must be \"double\" or \"float\"");
+            }
+
+            // Load bar aggregation settings
+            if (auto bars = yaml["bars"]) {
+                config_.bar_interval_seconds = bars["interval_seconds"].as<double>(60.0);
+                config_.volume_bar_threshold = bars["volume_threshold"].as<double>(0.0);
+                config_.bar_capacity = bars["capacity"].as<size_t>(1024);
+                if (config_.bar_interval_seconds <= 0.0) {
+                    throw std::runtime_error("bars.interval_seconds must be positive");
+                }
+            }
+
+            // Load return statistics settings
+            if (auto statistics = yaml["statistics"]) {
+                config_.stats_window = statistics["window"].as<size_t>(252);
+                config_.ewma_lambda = statistics["ewma_lambda"].as<double>(0.94);
+                config_.use_ewma = statistics["estimator"].as<std::string>("window") == "ewma";
+                if (config_.use_ewma && config_.ewma_lambda <= 0.0) {
+                    throw std::runtime_error("statistics.estimator \"ewma\" needs ewma_lambda > 0");
+                }
+            }
+
+            // Load parallel execution settings
+            if (auto parallel = yaml["parallel"]) {
+                config_.num_threads = parallel["threads"].as<size_t>(0);
+                config_.pin_threads = parallel["pin_threads"].as<bool>(false);
+            }
 
             // Load trading settings
             auto trading = yaml["trading"];
             config_.rebalance_interval = trading["rebalance_interval"].as<int>();
             config_.min_trade_size = trading["min_trade_size"].as<double>();
             config_.max_position_size = trading["max_position_size"].as<double>();
+            config_.amend_price_tolerance = trading["amend_price_tolerance"].as<double>(0.0005);
+            if (auto constraints = yaml["constraints"]) {
+                config_.max_daily_turnover = constraints["max_daily_turnover"].as<double>(0.0);
+            }
+
+            // Load rebalance trigger settings
+            if (auto scheduler = yaml["scheduler"]) {
+                config_.scheduler_poll_ms = scheduler["poll_ms"].as<int>(50);
+                config_.min_rebalance_interval_ms = scheduler["min_interval_ms"].as<int>(1000);
+                config_.price_move_threshold = scheduler["price_move_threshold"].as<double>(0.005);
+                config_.covariance_drift_threshold =
+                    scheduler["covariance_drift_threshold"].as<double>(0.10);
+                if (config_.scheduler_poll_ms <= 0) {
+                    throw std::runtime_error("scheduler.poll_ms must be positive");
+                }
+            }
 
             // Load risk settings
             auto risk = yaml["risk"];
             config_.var_confidence = risk["var_confidence"].as<double>();
             config_.max_drawdown_limit = risk["max_drawdown_limit"].as<double>();
+            config_.var_limit = risk["var_limit"].as<double>(0.0);
+            config_.var_method = risk["var_method"].as<std::string>("historical");
+            if (config_.var_method != "historical" && config_.var_method != "monte_carlo") {
+                throw std::runtime_error("risk.var_method must be \"historical\" or \"monte_carlo\"");
+            }
+            config_.mc_scenarios = risk["mc_scenarios"].as<size_t>(100000);
+            config_.mc_seed = risk["mc_seed"].as<uint64_t>(0x5EED);
+            config_.capital = risk["capital"].as<double>(0.0);
+            config_.max_leverage = risk["max_leverage"].as<double>(0.0);
+            config_.stop_loss = risk["stop_loss"].as<double>(0.0);
 
         } catch (const std::exception& e) {
             throw std::runtime_error("Failed to load config: " + std::string(e.what()));
@@ -130,6 +268,38 @@ private:
     }
 
     void initializeComponents() {
+        market_data_ = std::make_unique<MarketDataFeed>(
+            config_.symbols.size() + config_.symbol_headroom);
+        BarSettings bar_settings;
+        bar_settings.interval_ns = static_cast<int64_t>(config_.bar_interval_seconds * 1e9);
+        bar_settings.volume_threshold = config_.volume_bar_threshold;
+        bar_settings.capacity = config_.bar_capacity;
+        bars_ = std::make_unique<BarAggregator>(config_.symbols.size(), bar_settings);
+        return_stats_ = std::make_unique<ReturnStatistics>(
+            config_.symbols.size(), config_.stats_window, config_.ewma_lambda);
+        streaming_risk_ = std::make_unique<StreamingRiskMonitor>(
+            config_.var_confidence, config_.stats_window);
+        fix_trading_.attachSymbols(market_data_->symbols());
+
+        OrderManager::Settings order_settings;
+        order_settings.price_tolerance = config_.amend_price_tolerance;
+        order_manager_ = std::make_unique<OrderManager>(market_data_->symbols().capacity(),
+                                                        order_settings);
+        fix_trading_.attachOrderManager(*order_manager_);
+        positions_ = std::make_unique<PositionBook>(market_data_->symbols().capacity());
+        fix_trading_.attachPositionBook(*positions_);
+
+        if (config_.capital > 0.0) {
+            RiskLimits limits;
+            limits.capital = config_.capital;
+            limits.max_position = config_.max_position_size;
+            limits.max_daily_turnover = config_.max_daily_turnover;
+            limits.max_leverage = config_.max_leverage;
+            limits.stop_loss = config_.stop_loss;
+            risk_gate_ = std::make_unique<PreTradeRiskGate>(market_data_->symbols().capacity(), limits);
+            fix_trading_.attachRiskGate(*risk_gate_);
+        }
+
         // Initialize LUA interface
         lua_interface_.setPortfolio(&fix_trading_);
         
@@ -140,87 +310,369 @@ private:
         }
     }
 
-    void mainLoop(QuantumOptimizer& optimizer, RiskManager& risk_manager) {
+    std::unique_ptr<PortfolioOptimizer> makeOptimizer(const OptimizationParameters& params) {
+        size_t num_assets = config_.symbols.size();
+        if (config_.backend == "classical") {
+            return std::make_unique<ClassicalOptimizer>(num_assets, params);
+        }
+        if (config_.precision == "float") {
+            return std::make_unique<BasicQuantumOptimizer<float>>(num_assets, params,
+                                                                  thread_pool_.get());
+        }
+        return std::make_unique<QuantumOptimizer>(num_assets, params, thread_pool_.get());
+    }
+
+    struct MarketData {
+        std::vector<double> returns;
+        std::vector<std::vector<double>> covariance;
+        std::vector<double> current_prices;
+        std::vector<double> return_history;  // Row-major bars x assets, oldest first
+    };
+
+    struct RebalancePlan {
+        MarketData market_data;
+        std::vector<double> weights;
+        RiskManager::RiskMetrics risk_metrics;
+    };
+
+    using Scheduler = RebalanceScheduler<RebalancePlan>;
+
+    // Rebalances when prices move, the covariance drifts or the rebalance
+    // interval passes, whichever comes first; blocks until stop()
+    void runRebalancing(PortfolioOptimizer& optimizer, RiskManager& risk_manager) {
+        Scheduler::Settings settings;
+        settings.poll_interval = std::chrono::milliseconds(config_.scheduler_poll_ms);
+        settings.min_interval = std::chrono::milliseconds(config_.min_rebalance_interval_ms);
+        settings.max_interval = std::chrono::seconds(config_.rebalance_interval);
+        scheduler_ = std::make_unique<Scheduler>(ioc_, settings);
+
+        if (config_.price_move_threshold > 0.0) {
+            scheduler_->addTrigger({"price",
+                [this] { return priceMoved(); },
+                [this] { rebasePrices(); }});
+        }
+        if (config_.covariance_drift_threshold > 0.0) {
+            scheduler_->addTrigger({"covariance",
+                [this] { return covarianceDrifted(); },
+                [this] { rebaseCovariance(); }});
+        }
+        // Risk of the held positions, marked to the latest quotes every poll
+        scheduler_->addTrigger({"risk",
+            [this] { return riskLimitBreached(); },
+            nullptr});
+        scheduler_->setEventClock([this] { return latestQuoteTime(); });
+
+        scheduler_->start(
+            [this, &optimizer, &risk_manager](const Scheduler::Cycle& cycle, RebalancePlan& plan) {
+                return computeRebalance(cycle, optimizer, risk_manager, plan);
+            },
+            [this](const Scheduler::Cycle& cycle, RebalancePlan& plan) {
+                executeRebalance(cycle, plan);
+            });
+
         while (running_) {
-            try {
-                // Collect market data
-                auto market_data = collectMarketData();
-                
-                // Run optimization
-                auto weights = optimizer.optimize(
-                    market_data.returns,
-                    market_data.covariance
-                );
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        scheduler_->stop();
+        std::cout << "Tick-to-order latency: " << scheduler_->latency().summary() << std::endl;
+    }
 
-                // Calculate risk metrics
-                auto risk_metrics = risk_manager.calculateRiskMetrics(
-                    market_data.returns,
-                    weights
-                );
+    // Compute stage: market data, optimization and risk checks
+    bool computeRebalance(const Scheduler::Cycle& cycle, PortfolioOptimizer& optimizer,
+                          RiskManager& risk_manager, RebalancePlan& plan) {
+        plan.market_data = collectMarketData();
+        if (!cold_start_logged_ && market_data_->coldStartMs() >= 0.0) {
+            std::cout << "All " << symbol_ids_.size() << " symbols live after "
+                      << market_data_->coldStartMs() << " ms" << std::endl;
+            cold_start_logged_ = true;
+        }
 
-                // Check risk limits
-                if (risk_metrics.max_drawdown > config_.max_drawdown_limit) {
-                    std::cout << "Warning: Max drawdown limit exceeded" << std::endl;
-                    reduceRisk(weights);
-                }
+        // Need two bars of returns before there is a covariance
+        if (plan.market_data.returns.empty()) return false;
+
+        // Run optimization
+        plan.weights = optimizer.optimize(
+            plan.market_data.returns,
+            plan.market_data.covariance
+        );
+
+        const auto& stats = optimizer.lastStats();
+        std::cout << "Rebalance " << cycle.id << " (" << cycle.reasons << "): "
+                  << stats.iterations_run << "/" << stats.iteration_budget << " iterations"
+                  << (stats.converged ? " (converged)" : "")
+                  << ", " << stats.elapsed_ms << " ms, ~"
+                  << stats.saved_ms << " ms saved" << std::endl;
+
+        // Calculate risk metrics
+        plan.risk_metrics = risk_manager.calculateRiskMetrics(
+            plan.market_data.return_history,
+            plan.weights
+        );
+        if (mc_var_) {
+            // Simulated tail from the same covariance the optimizer saw;
+            // the factor is only recomputed when that covariance changed
+            mc_var_->setCovariance(plan.market_data.covariance);
+            auto simulated = mc_var_->evaluate(plan.weights, plan.market_data.returns);
+            plan.risk_metrics.var = simulated.var;
+            plan.risk_metrics.cvar = simulated.cvar;
+        }
 
-                // Execute strategy adjustments
-                executeLuaStrategy(weights, risk_metrics);
+        // Check risk limits
+        if (plan.risk_metrics.max_drawdown > config_.max_drawdown_limit) {
+            std::cout << "Warning: Max drawdown limit exceeded" << std::endl;
+            reduceRisk(plan.weights);
+        }
+        return true;
+    }
 
-                // Execute trades
-                executeTrades(weights, market_data);
+    // Execute stage: strategy hooks and orders; may overlap the next
+    // cycle's compute stage
+    void executeRebalance(const Scheduler::Cycle& cycle, RebalancePlan& plan) {
+        // Execute strategy adjustments
+        executeLuaStrategy(plan.weights, plan.risk_metrics);
 
-                // Log state
-                logState(weights, risk_metrics, market_data);
+        // Execute trades
+        executeTrades(plan.weights, plan.market_data);
 
-                std::this_thread::sleep_for(
-                    std::chrono::seconds(config_.rebalance_interval)
-                );
+        // Log state
+        logState(plan.weights, plan.risk_metrics, plan.market_data);
 
-            } catch (const std::exception& e) {
-                std::cerr << "Error in main loop: " << e.what() << std::endl;
-                std::this_thread::sleep_for(std::chrono::seconds(5));
+        if (cycle.id % 10 == 0) {
+            std::cout << "Tick-to-order latency: " << scheduler_->latency().summary() << std::endl;
+        }
+    }
+
+    bool priceMoved() {
+        if (reference_prices_.size() != symbol_ids_.size()) return false;
+        for (size_t i = 0; i < symbol_ids_.size(); ++i) {
+            double reference = reference_prices_[i];
+            double price = market_data_->getLatestQuote(symbol_ids_[i]).price;
+            if (reference > 0.0 && std::abs(price / reference - 1.0) > config_.price_move_threshold) {
+                return true;
             }
         }
+        return false;
     }
 
-    struct MarketData {
-        std::vector<double> returns;
-        std::vector<std::vector<double>> covariance;
-        std::vector<double> current_prices;
-    };
+    void rebasePrices() {
+        reference_prices_.resize(symbol_ids_.size());
+        for (size_t i = 0; i < symbol_ids_.size(); ++i) {
+            reference_prices_[i] = market_data_->getLatestQuote(symbol_ids_[i]).price;
+        }
+    }
+
+    // Relative Frobenius change of the packed covariance since the last
+    // rebalance; only recomputed when new bars came in
+    bool covarianceDrifted() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        if (!ingestBars() || !return_stats_->ready() || reference_covariance_.empty()) return false;
+
+        packedCovariance(current_covariance_);
+        double diff = 0.0, norm = 0.0;
+        for (size_t k = 0; k < current_covariance_.size(); ++k) {
+            double d = current_covariance_[k] - reference_covariance_[k];
+            diff += d * d;
+            norm += reference_covariance_[k] * reference_covariance_[k];
+        }
+        return norm > 0.0 && std::sqrt(diff / norm) > config_.covariance_drift_threshold;
+    }
+
+    void rebaseCovariance() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        ingestBars();
+        if (return_stats_->ready()) packedCovariance(reference_covariance_);
+    }
+
+    // Fires once when the held portfolio first crosses the drawdown or VaR
+    // limit, and again only after it has recovered
+    bool riskLimitBreached() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        ingestBars();
+        markStreamingRisk();
+        bool breached = streaming_risk_->drawdown() > config_.max_drawdown_limit ||
+                        (config_.var_limit > 0.0 && streaming_risk_->var() > config_.var_limit);
+        bool fire = breached && !risk_breached_;
+        risk_breached_ = breached;
+        return fire;
+    }
+
+    void packedCovariance(std::vector<double>& out) const {
+        out.resize(ReturnStatistics::packedSize(return_stats_->numAssets()));
+        if (config_.use_ewma) {
+            std::copy(return_stats_->packedEwmaCovariance(),
+                      return_stats_->packedEwmaCovariance() + out.size(), out.begin());
+        } else {
+            return_stats_->packedCovariance(out.data());
+        }
+    }
+
+    std::chrono::system_clock::time_point latestQuoteTime() const {
+        std::chrono::system_clock::time_point latest;
+        for (SymbolId id : symbol_ids_) {
+            latest = std::max(latest, market_data_->getLatestQuote(id).timestamp);
+        }
+        return latest;
+    }
 
     MarketData collectMarketData() {
         MarketData data;
-        for (const auto& symbol : config_.symbols) {
-            auto market_update = market_data_.getLatestData(symbol);
-            data.current_prices.push_back(market_update.price);
-            // Calculate returns and covariance here
+        for (SymbolId id : symbol_ids_) {
+            auto quote = market_data_->getLatestQuote(id);
+            data.current_prices.push_back(quote.price);
+        }
+
+        // The estimates are updated in place, so reading them out costs
+        // O(n^2) regardless of the window length
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        ingestBars();
+        if (return_stats_->ready()) {
+            return_stats_->meanReturns(data.returns, config_.use_ewma);
+            return_stats_->covariance(data.covariance, config_.use_ewma);
+            return_stats_->windowReturns(data.return_history);
         }
         return data;
     }
 
+    // Feeds every time bar closed since the last call into the statistics;
+    // returns true if there were any. Bars are closed up to the newest tick
+    // rather than the wall clock, so a replay yields only the bars its ticks
+    // span. Caller holds stats_mutex_.
+    bool ingestBars() {
+        bars_->closeThrough(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            latestQuoteTime().time_since_epoch()).count());
+        bars_consumed_ = bars_->timeBarsSince(BarField::Close, bars_consumed_,
+                                              config_.bar_capacity, bar_closes_);
+        size_t fresh = bars_->numSymbols() ? bar_closes_.size() / bars_->numSymbols() : 0;
+        std::vector<double> prices(symbol_ids_.size());
+        for (size_t row = 0; row < fresh; ++row) {
+            const double* bar = bar_closes_.data() + row * bars_->numSymbols();
+            for (size_t i = 0; i < symbol_ids_.size(); ++i) {
+                prices[i] = bar[symbol_ids_[i]];
+            }
+            return_stats_->addPrices(prices.data());
+        }
+        return fresh > 0;
+    }
+
+    // Marks the held positions (as filled, from the position book) to the
+    // latest quotes and feeds their return since the previous mark to the
+    // streaming risk monitor, so drawdown and VaR limits see every tick
+    // instead of every closed bar. Polls without a new quote add nothing.
+    // Caller holds stats_mutex_.
+    void markStreamingRisk() {
+        const size_t n = symbol_ids_.size();
+        bool fresh = mark_prices_.size() != n;
+        if (fresh) {
+            mark_prices_.assign(n, 0.0);
+            mark_versions_.assign(n, 0);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            fresh = fresh || market_data_->quoteVersion(symbol_ids_[i]) != mark_versions_[i];
+        }
+        if (!fresh) return;
+
+        // Value at the previous marks, then the P&L of moving to the new ones
+        double value = portfolioValue(mark_prices_);
+        double pnl = 0.0;
+        bool held = false;
+        for (size_t i = 0; i < n; ++i) {
+            auto quote = market_data_->getLatestQuote(symbol_ids_[i]);
+            double quantity = positions_->quantity(symbol_ids_[i]);
+            if (quantity != 0.0 && mark_prices_[i] > 0.0 && quote.price > 0.0) {
+                pnl += quantity * (quote.price - mark_prices_[i]);
+                held = true;
+            }
+            if (quote.price > 0.0) mark_prices_[i] = quote.price;
+            mark_versions_[i] = quote.version;
+        }
+        if (held && value > 0.0) streaming_risk_->update(pnl / value);
+    }
+
+    // Brings the gate's marks, daily P&L and trading day up to date before
+    // the orders it will check
+    void markRiskGate(const MarketData& market_data) {
+        if (!risk_gate_) return;
+        auto day = std::chrono::duration_cast<std::chrono::hours>(
+            std::chrono::system_clock::now().time_since_epoch()).count() / 24;
+        for (size_t i = 0; i < symbol_ids_.size(); ++i) {
+            risk_gate_->mark(symbol_ids_[i], market_data.current_prices[i]);
+        }
+        if (day != trading_day_) {
+            risk_gate_->resetDay();
+            trading_day_ = day;
+        }
+        bool was_halted = risk_gate_->halted();
+        if (risk_gate_->updateStopLoss() && !was_halted) {
+            std::cout << "Stop loss hit: daily P&L " << risk_gate_->dailyPnl()
+                      << ", only risk-reducing orders until tomorrow" << std::endl;
+        }
+    }
+
+    // Account value the weights refer to: capital plus realized and
+    // unrealized P&L from the position book, or the marked value of the
+    // holdings when no capital is configured. Computed once per rebalance
+    // so each weight query is a single seqlock read.
+    double portfolioValue(const std::vector<double>& prices) const {
+        double value = config_.capital > 0.0 ? config_.capital + positions_->realizedPnl() : 0.0;
+        for (size_t i = 0; i < symbol_ids_.size(); ++i) {
+            PositionBook::Position position = positions_->read(symbol_ids_[i]);
+            double mark = prices[i];
+            value += config_.capital > 0.0 ? position.unrealizedPnl(mark) : position.marketValue(mark);
+        }
+        return value;
+    }
+
+    double getCurrentWeight(size_t i, const MarketData& market_data) const {
+        if (!(portfolio_value_ > 0.0)) return 0.0;
+        return positions_->quantity(symbol_ids_[i]) * market_data.current_prices[i] / portfolio_value_;
+    }
+
+    double calculateQuantity(double weight_diff, double price) const {
+        return price > 0.0 ? weight_diff * portfolio_value_ / price : 0.0;
+    }
+
     void executeTrades(const std::vector<double>& target_weights, 
                       const MarketData& market_data) {
+        markRiskGate(market_data);
+        portfolio_value_ = portfolioValue(market_data.current_prices);
+        if (!(portfolio_value_ > 0.0)) {
+            std::cout << "No account value to size orders against; set risk.capital" << std::endl;
+            return;
+        }
+
+        // Net every symbol's delta against its working order, then send
+        // the whole rebalance in one pass
+        order_batch_.clear();
         for (size_t i = 0; i < config_.symbols.size(); ++i) {
-            double current_weight = getCurrentWeight(config_.symbols[i]);
+            double current_weight = getCurrentWeight(i, market_data);
             double weight_diff = target_weights[i] - current_weight;
-            
+
+            // Inside the dead band the target is met; a working order is cancelled
+            double signed_quantity = 0.0;
             if (std::abs(weight_diff) > config_.min_trade_size) {
                 double quantity = calculateQuantity(
                     weight_diff, 
                     market_data.current_prices[i]
                 );
-                
-                char side = (weight_diff > 0) ? 'B' : 'S';
-                fix_trading_.sendOrder(
-                    config_.symbols[i],
-                    side,
-                    std::abs(quantity),
-                    market_data.current_prices[i]
-                );
+                signed_quantity = weight_diff > 0 ? std::abs(quantity) : -std::abs(quantity);
             }
+            order_manager_->net(symbol_ids_[i], signed_quantity, market_data.current_prices[i],
+                                order_batch_);
+        }
+        size_t sent = fix_trading_.submit(order_batch_);
+
+        for (const OrderAction& action : order_batch_) {
+            if (action.result == RiskCheck::Accepted) continue;
+            const std::string& symbol = market_data_->symbols().name(action.symbol);
+            std::cout << "Order rejected by risk gate: " << symbol
+                      << " " << riskCheckName(action.result) << std::endl;
+            lua_interface_.onOrderRejected(symbol, action.side, action.quantity, action.price,
+                                           riskCheckName(action.result));
         }
+        auto counters = order_manager_->counters();
+        std::cout << "Orders: " << sent << " messages, " << order_manager_->liveOrders()
+                  << " working, " << counters.netted << " netted, "
+                  << counters.sent_replace << " amended so far" << std::endl;
     }
 
     void logState(const std::vector<double>& weights,
@@ -232,9 +684,32 @@ private:
     std::atomic<bool> running_;
     boost::asio::io_context ioc_;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
-    MarketDataFeed market_data_;
+    std::unique_ptr<BarAggregator> bars_;  // Declared before the feed, which pushes into it
+    std::unique_ptr<MarketDataFeed> market_data_;  // Sized from the configured symbols
+    std::vector<SymbolId> symbol_ids_;  // Parallel to config_.symbols
+    bool cold_start_logged_ = false;
+    std::unique_ptr<PreTradeRiskGate> risk_gate_;  // Declared before FIX, which reports fills into it
+    std::unique_ptr<OrderManager> order_manager_;  // Likewise for execution reports
+    std::unique_ptr<PositionBook> positions_;      // And for fills
+    double portfolio_value_ = 0.0;  // Set at the start of each executeTrades
+    std::vector<OrderAction> order_batch_;
+    int64_t trading_day_ = -1;
     FixTrading fix_trading_;
     LuaInterface lua_interface_;
+    std::unique_ptr<ThreadPool> thread_pool_;
+    std::unique_ptr<MonteCarloVaR> mc_var_;  // Set when risk.var_method is "monte_carlo"
+    kernels::AlignedVector<double> bar_closes_;
+    size_t bars_consumed_ = 0;
+    std::unique_ptr<ReturnStatistics> return_stats_;
+    std::mutex stats_mutex_;  // Guards return_stats_ between triggers and compute
+    std::unique_ptr<StreamingRiskMonitor> streaming_risk_;  // Guarded by stats_mutex_
+    std::vector<double> mark_prices_;                      // Guarded by stats_mutex_
+    std::vector<uint64_t> mark_versions_;                  // Likewise
+    bool risk_breached_ = false;
+    std::unique_ptr<Scheduler> scheduler_;
+    std::vector<double> reference_prices_;
+    std::vector<double> reference_covariance_;
+    std::vector<double> current_covariance_;
     Config config_;
 };
 